@@ -0,0 +1,143 @@
+                section         .text
+
+; Long arithmetic of add.asm, sub.asm and mul.asm, also callable from C and C++ (long_arith.h).
+; Long numbers are arrays of qwords, least significant first. The entry points follow the
+; System V AMD64 ABI: arguments in rdi, rsi, rdx, rcx, the result in rax, rbx, rbp and
+; r12 - r15 preserved. Every length may be zero.
+
+                global          add_long_long
+                global          sub_long_long
+                global          mul_long_long
+                global          mul_long_short
+                global          div_long_short
+
+; uint64_t add_long_long(uint64_t* dst, uint64_t const* src, size_t n)
+;    dst += src
+; result:
+;    rax -- carry out of the top qword
+add_long_long:
+                xor             eax, eax                ; also clears CF
+                mov             rcx, rdx
+                jrcxz           .done
+.loop:
+                mov             r8, [rsi]
+                lea             rsi, [rsi + 8]
+                adc             [rdi], r8
+                lea             rdi, [rdi + 8]
+                dec             rcx                     ; leaves CF alone
+                jnz             .loop
+                setc            al
+.done:
+                ret
+
+; uint64_t sub_long_long(uint64_t* dst, uint64_t const* src, size_t n)
+;    dst -= src
+; result:
+;    rax -- borrow out of the top qword
+sub_long_long:
+                xor             eax, eax
+                mov             rcx, rdx
+                jrcxz           .done
+.loop:
+                mov             r8, [rsi]
+                lea             rsi, [rsi + 8]
+                sbb             [rdi], r8
+                lea             rdi, [rdi + 8]
+                dec             rcx
+                jnz             .loop
+                setc            al
+.done:
+                ret
+
+; void mul_long_long(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n)
+;    r = a * b, 2 * n qwords; r must not overlap a or b
+mul_long_long:
+                push            rbx
+                push            r12
+
+                mov             r9, rdx                 ; r9 = b
+                mov             r10, rcx                ; r10 = n
+                mov             r11, rdi
+                lea             rcx, [rcx + rcx]
+                xor             eax, eax
+                rep stosq                               ; initialize result with zero
+                mov             rdi, r11
+
+; rdi is r + i, rsi is a + i, rbx is .outer counter
+                mov             rbx, r10
+                test            rbx, rbx
+                jz              .done
+.outer:
+                mov             r8, r9                  ; r8 = b + j
+                mov             r11, rdi                ; r11 = r + i + j
+                mov             rcx, r10
+                xor             r12d, r12d              ; r12 is carry
+.inner:
+                mov             rax, [r8]
+                mul             qword [rsi]             ; rdx:rax = a[i] * b[j]
+                add             rax, [r11]
+                adc             rdx, 0
+                add             rax, r12
+                adc             rdx, 0
+                mov             [r11], rax
+                mov             r12, rdx
+                add             r8, 8
+                add             r11, 8
+                dec             rcx
+                jnz             .inner
+
+                mov             [r11], r12              ; r[i + n] is still zero
+                add             rsi, 8
+                add             rdi, 8
+                dec             rbx
+                jnz             .outer
+.done:
+                pop             r12
+                pop             rbx
+                ret
+
+; uint64_t mul_long_short(uint64_t* a, size_t n, uint64_t m)
+;    a *= m
+; result:
+;    rax -- qword carried out of the top
+mul_long_short:
+                mov             r8, rdx                 ; mul takes rdx
+                xor             ecx, ecx                ; rcx is carry
+                test            rsi, rsi
+                jz              .done
+.loop:
+                mov             rax, [rdi]
+                mul             r8
+                add             rax, rcx
+                adc             rdx, 0
+                mov             [rdi], rax
+                add             rdi, 8
+                mov             rcx, rdx
+                dec             rsi
+                jnz             .loop
+.done:
+                mov             rax, rcx
+                ret
+
+; uint64_t div_long_short(uint64_t* a, size_t n, uint64_t d)
+;    a /= d, d != 0
+; result:
+;    rax -- remainder
+div_long_short:
+                mov             r8, rdx                 ; div takes rdx
+                xor             edx, edx
+                test            rsi, rsi
+                jz              .done
+                lea             rdi, [rdi + 8 * rsi - 8]
+.loop:
+                mov             rax, [rdi]
+                div             r8
+                mov             [rdi], rax
+                sub             rdi, 8
+                dec             rsi
+                jnz             .loop
+.done:
+                mov             rax, rdx
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
@@ -0,0 +1,23 @@
+#ifndef LONG_ARITH_H
+#define LONG_ARITH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Entry points of long_arith.asm. Long numbers are n qwords, least significant first. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t add_long_long(uint64_t* dst, uint64_t const* src, size_t n);        /* dst += src, returns the carry */
+uint64_t sub_long_long(uint64_t* dst, uint64_t const* src, size_t n);        /* dst -= src, returns the borrow */
+void mul_long_long(uint64_t* r, uint64_t const* a, uint64_t const* b, size_t n); /* r[0 .. 2n) = a * b, no overlap */
+uint64_t mul_long_short(uint64_t* a, size_t n, uint64_t m);                  /* a *= m, returns the top qword */
+uint64_t div_long_short(uint64_t* a, size_t n, uint64_t d);                  /* a /= d, returns the remainder */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LONG_ARITH_H */
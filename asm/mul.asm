@@ -1,5 +1,8 @@
                 section         .text
 
+; the arithmetic comes from long_arith.asm (System V calling convention)
+                extern          mul_long_long, mul_long_short, div_long_short
+
                 global          _start
 _start:
 
@@ -12,15 +15,13 @@ _start:
                 lea             rsi, [rsp + 128 * 8]
 
                 sub             rsp, 256 * 8
-                mov             rdi, rsp
-
-                add             rdi, 256 * 8
-                mov             r8, rsp
+                mov             rdi, rsp                ; product
+                lea             rdx, [rsp + 256 * 8]
 
                 call            mul_long_long
 
-                add             rcx, rcx
-                mov             rdi, r8
+                mov             rcx, 256
+                mov             rdi, rsp
 
                 call            write_long
 
@@ -29,78 +30,6 @@ _start:
 
                 jmp             exit
 
-; muls two long number
-;    rdi -- address of #1 (long number)
-;    rsi -- address of #2 (long number)
-;    rcx -- length of long numbers in qwords
-; result:
-;    mul is written to r8
-;    length of result is 2*rcx
-;    memory for result shoud be reserved before mul call
-mul_long_long:
-                push            rdi
-                push            rsi
-                push            rcx
-                push            r8
-
-                mov             r10, rdi
-                mov             r11, rcx
-
-                add             rcx, rcx
-                mov             rdi, r8
-                call            set_zero                ; initialize result with zero
-
-                mov             rdi, r10
-                mov             rcx, r11
-
-; r9 is .loop1 counter
-; r10 is carry
-
-                mov             r9, rcx
-
-.loop0:
-                mov             r10, 0
-                push            r9
-                push            rsi
-                push            r8
-
-.loop1:
-; body of .loop1
-                mov             rax, [rdi]              ; rax = a[i]
-                mov             rbx, [rsi]              ; rbx = b[i]
-                mul             rbx                     ; rdx = a[i] * b[i] / BASE
-                                                        ; rax = a[i] * b[i] % BASE
-                add             rax, [r8]
-                adc             rdx, 0
-                add             rax, r10
-                adc             rdx, 0
-                mov             [r8], rax
-                mov             r10, rdx
-
-                add             r8, 8                   ; r8++
-                add             rsi, 8                  ; rsi++
-                dec             r9                      ; r9--
-                jnz             .loop1
-
-; add carry
-                mov             [r8], r10
-
-                pop             r8
-                pop             rsi
-                pop             r9
-; body of .loop
-
-                add             r8, 8                   ; r8++
-                add             rdi, 8                  ; rdi++
-                dec             rcx                     ; rcx--
-                jnz             .loop0
-
-                pop             r8
-                pop             rcx
-                pop             rsi
-                pop             rdi
-                ret
-
 ; adds 64-bit number to long number
 ;    rdi -- address of summand #1 (long number)
 ;    rax -- summand #2 (64-bit unsigned)
@@ -127,62 +56,6 @@ add_long_short:
                 pop             rdi
                 ret
 
-; multiplies long number by a short
-;    rdi -- address of multiplier #1 (long number)
-;    rbx -- multiplier #2 (64-bit unsigned)
-;    rcx -- length of long number in qwords
-; result:
-;    product is written to rdi
-mul_long_short:
-                push            rax
-                push            rdi
-                push            rcx
-
-                xor             rsi, rsi
-.loop:
-                mov             rax, [rdi]
-                mul             rbx
-                add             rax, rsi
-                adc             rdx, 0
-                mov             [rdi], rax
-                add             rdi, 8
-                mov             rsi, rdx
-                dec             rcx
-                jnz             .loop
-
-                pop             rcx
-                pop             rdi
-                pop             rax
-                ret
-
-; divides long number by a short
-;    rdi -- address of dividend (long number)
-;    rbx -- divisor (64-bit unsigned)
-;    rcx -- length of long number in qwords
-; result:
-;    quotient is written to rdi
-;    rdx -- remainder
-div_long_short:
-                push            rdi
-                push            rax
-                push            rcx
-
-                lea             rdi, [rdi + 8 * rcx - 8]
-                xor             rdx, rdx
-
-.loop:
-                mov             rax, [rdi]
-                div             rbx
-                mov             [rdi], rax
-                sub             rdi, 8
-                dec             rcx
-                jnz             .loop
-
-                pop             rcx
-                pop             rax
-                pop             rdi
-                ret
-
 ; assigns a zero to long number
 ;    rdi -- argument (long number)
 ;    rcx -- length of long number in qwords
@@ -237,8 +110,15 @@ read_long:
                 ja              .invalid_char
 
                 sub             rax, '0'
-                mov             rbx, 10
+                push            rax
+                push            rdi
+                push            rcx
+                mov             rsi, rcx
+                mov             rdx, 10
                 call            mul_long_short
+                pop             rcx
+                pop             rdi
+                pop             rax
                 call            add_long_short
                 jmp             .loop
 
@@ -278,11 +158,18 @@ write_long:
                 mov             rsi, rbp
 
 .loop:
-                mov             rbx, 10
-                call            div_long_short
-                add             rdx, '0'
+                push            rsi
+                push            rdi
+                push            rcx
+                mov             rsi, rcx
+                mov             rdx, 10
+                call            div_long_short          ; rax -- remainder
+                pop             rcx
+                pop             rdi
+                pop             rsi
+                add             al, '0'
                 dec             rsi
-                mov             [rsi], dl
+                mov             [rsi], al
                 call            is_zero
                 jnz             .loop
 
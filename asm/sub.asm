@@ -1,5 +1,8 @@
                 section         .text
 
+; the arithmetic comes from long_arith.asm (System V calling convention)
+                extern          sub_long_long, mul_long_short, div_long_short
+
                 global          _start
 _start:
 
@@ -15,7 +18,10 @@ _start:
                 xor             rsi, rdi
                 xor             rdi, rsi
 
+                mov             rdx, rcx
                 call            sub_long_long
+                lea             rdi, [rsp + 128 * 8]
+                mov             rcx, 128
 
                 call            write_long
 
@@ -24,31 +30,6 @@ _start:
 
                 jmp             exit
 
-; subs two long number
-;    rdi -- address of #1 (long number)
-;    rsi -- address of #2 (long number)
-;    rcx -- length of long numbers in qwords
-; result:
-;    sub is written to rdi
-sub_long_long:
-                push            rdi
-                push            rsi
-                push            rcx
-
-                clc
-.loop:
-                mov             rax, [rsi]
-                lea             rsi, [rsi + 8]
-                sbb             [rdi], rax
-                lea             rdi, [rdi + 8]
-                dec             rcx
-                jnz             .loop
-
-                pop             rcx
-                pop             rsi
-                pop             rdi
-                ret
-
 ; adds 64-bit number to long number
 ;    rdi -- address of summand #1 (long number)
 ;    rax -- summand #2 (64-bit unsigned)
@@ -75,62 +56,6 @@ add_long_short:
                 pop             rdi
                 ret
 
-; multiplies long number by a short
-;    rdi -- address of multiplier #1 (long number)
-;    rbx -- multiplier #2 (64-bit unsigned)
-;    rcx -- length of long number in qwords
-; result:
-;    product is written to rdi
-mul_long_short:
-                push            rax
-                push            rdi
-                push            rcx
-
-                xor             rsi, rsi
-.loop:
-                mov             rax, [rdi]
-                mul             rbx
-                add             rax, rsi
-                adc             rdx, 0
-                mov             [rdi], rax
-                add             rdi, 8
-                mov             rsi, rdx
-                dec             rcx
-                jnz             .loop
-
-                pop             rcx
-                pop             rdi
-                pop             rax
-                ret
-
-; divides long number by a short
-;    rdi -- address of dividend (long number)
-;    rbx -- divisor (64-bit unsigned)
-;    rcx -- length of long number in qwords
-; result:
-;    quotient is written to rdi
-;    rdx -- remainder
-div_long_short:
-                push            rdi
-                push            rax
-                push            rcx
-
-                lea             rdi, [rdi + 8 * rcx - 8]
-                xor             rdx, rdx
-
-.loop:
-                mov             rax, [rdi]
-                div             rbx
-                mov             [rdi], rax
-                sub             rdi, 8
-                dec             rcx
-                jnz             .loop
-
-                pop             rcx
-                pop             rax
-                pop             rdi
-                ret
-
 ; assigns a zero to long number
 ;    rdi -- argument (long number)
 ;    rcx -- length of long number in qwords
@@ -185,8 +110,15 @@ read_long:
                 ja              .invalid_char
 
                 sub             rax, '0'
-                mov             rbx, 10
+                push            rax
+                push            rdi
+                push            rcx
+                mov             rsi, rcx
+                mov             rdx, 10
                 call            mul_long_short
+                pop             rcx
+                pop             rdi
+                pop             rax
                 call            add_long_short
                 jmp             .loop
 
@@ -226,11 +158,18 @@ write_long:
                 mov             rsi, rbp
 
 .loop:
-                mov             rbx, 10
-                call            div_long_short
-                add             rdx, '0'
+                push            rsi
+                push            rdi
+                push            rcx
+                mov             rsi, rcx
+                mov             rdx, 10
+                call            div_long_short          ; rax -- remainder
+                pop             rcx
+                pop             rdi
+                pop             rsi
+                add             al, '0'
                 dec             rsi
-                mov             [rsi], dl
+                mov             [rsi], al
                 call            is_zero
                 jnz             .loop
 
@@ -0,0 +1,95 @@
+#include "big_accumulator.h"
+
+#include <stdexcept>
+
+namespace {
+    // carries lanes into limbs: on return lanes[i] < 2 ^ 32 for every i, the signed carry out of
+    // the top lane is returned
+    int64_t propagate(uint64_t const* lanes, uint32_t* limbs, size_t n) {
+        int64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            int64_t v = static_cast<int64_t>(lanes[i]) + carry;
+            limbs[i] = static_cast<uint32_t>(v);
+            carry = v >> 32;
+        }
+        return carry;
+    }
+}
+
+big_accumulator::big_accumulator(size_t max_pending) : pending_(0), max_pending_(max_pending) {
+    if (max_pending == 0 || max_pending > MAX_PENDING) {
+        throw std::invalid_argument("big_accumulator: max_pending out of range");
+    }
+}
+
+big_accumulator& big_accumulator::operator+=(big_integer const& rhs) {
+    add_limbs(rhs, false);
+    return *this;
+}
+
+big_accumulator& big_accumulator::operator-=(big_integer const& rhs) {
+    add_limbs(rhs, true);
+    return *this;
+}
+
+// two's complement: x = sum(limb_i * 2 ^ {32 i}) - (x < 0) * 2 ^ {32 n}
+void big_accumulator::add_limbs(big_integer const& x, bool subtract) {
+    if (pending_ >= max_pending_) {                                 // a merge may leave up to MAX_PENDING
+        normalize();
+    }
+    size_t n = x.digits_.size();
+    if (lanes_.size() < n + 1) {
+        lanes_.resize(n + 1, 0);
+    }
+    uint64_t* lanes = lanes_.data();
+    uint32_t const* limbs = x.digits_.data();
+    if (subtract) {
+        for (size_t i = 0; i < n; i++) {
+            lanes[i] -= limbs[i];
+        }
+        lanes[n] += x.sign_ & 1;
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            lanes[i] += limbs[i];
+        }
+        lanes[n] -= x.sign_ & 1;
+    }
+    pending_++;
+}
+
+void big_accumulator::normalize() {
+    std::vector<uint32_t> limbs(lanes_.size());
+    int64_t carry = propagate(lanes_.data(), limbs.data(), lanes_.size());
+    for (size_t i = 0; i < limbs.size(); i++) {
+        lanes_[i] = limbs[i];
+    }
+    if (carry != 0) {
+        lanes_.push_back(static_cast<uint64_t>(carry));
+    }
+    pending_ = 0;
+}
+
+void big_accumulator::merge(big_accumulator const& other) {
+    if (pending_ + other.pending_ > max_pending_) {
+        normalize();                                                // other.pending_ alone is within MAX_PENDING
+    }
+    if (lanes_.size() < other.lanes_.size()) {
+        lanes_.resize(other.lanes_.size(), 0);
+    }
+    for (size_t i = 0; i < other.lanes_.size(); i++) {
+        lanes_[i] += other.lanes_[i];
+    }
+    pending_ += other.pending_;
+}
+
+void big_accumulator::clear() {
+    lanes_.clear();
+    pending_ = 0;
+}
+
+big_integer big_accumulator::value() const {
+    std::vector<uint32_t> limbs(lanes_.size() + 1);
+    int64_t carry = propagate(lanes_.data(), limbs.data(), lanes_.size());
+    limbs.back() = static_cast<uint32_t>(carry);                    // |carry| < 2 ^ 31
+    return big_integer::from_limbs(limbs.data(), limbs.size(), carry < 0);
+}
@@ -0,0 +1,36 @@
+#ifndef BIG_ACCUMULATOR_H
+#define BIG_ACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <big_integer.h>
+
+// Running sum of big integers in carry-save form: limb i of every term is added into 64-bit
+// lane i, so a term costs one pass over its own limbs, with no carries, resizes or shrinking.
+// Lanes hold signed sums; a negative term also takes 1 from the lane above its top limb.
+// Carries are propagated once by value(), or in place every max_pending terms (at most
+// MAX_PENDING, before a lane could leave the int64_t range). Partial sums built independently (say, one per thread) merge()
+// into one.
+struct big_accumulator {
+    static const size_t MAX_PENDING = size_t(1) << 30;             // |lane| stays below 2 ^ 63
+
+    explicit big_accumulator(size_t max_pending = MAX_PENDING);   // throws std::invalid_argument unless 1 .. MAX_PENDING
+
+    big_accumulator& operator+=(big_integer const& rhs);
+    big_accumulator& operator-=(big_integer const& rhs);
+    void merge(big_accumulator const& other);
+    void clear();
+
+    big_integer value() const;
+
+ private:
+    void add_limbs(big_integer const& x, bool subtract);
+    void normalize();
+
+    std::vector<uint64_t> lanes_;                                   // int64_t values, stored unsigned to wrap freely
+    size_t pending_;                                                // terms added since lanes_ last held limbs
+    size_t max_pending_;
+};
+
+#endif // BIG_ACCUMULATOR_H
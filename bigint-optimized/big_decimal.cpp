@@ -0,0 +1,247 @@
+#include "big_decimal.h"
+#include "big_integer_powers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    __extension__ typedef __int128 int128_t;                        // a GCC extension, named once for -pedantic
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    const size_t UINT64_DIGITS = 19;                                // 10^19 - 1 < 2^64
+
+    big_integer aligned(big_integer const& unscaled, size_t from, size_t to) {
+        return from == to ? unscaled : unscaled * big_integer_powers::ten(to - from);
+    }
+
+    // digits of a decimal number without the point: a short one through a uint64_t, a long one
+    // through big_integer's own parser, which splits the work instead of growing an accumulator
+    big_integer parse_digits(std::string const& str, size_t first, size_t point, size_t last) {
+        size_t digits = last - first - (point != std::string::npos);
+        if (digits <= UINT64_DIGITS) {
+            uint64_t value = 0;
+            for (size_t pos = first; pos < last; pos++) {
+                if (pos != point) {
+                    value = value * 10 + static_cast<uint64_t>(str[pos] - '0');
+                }
+            }
+            return big_integer(value);
+        }
+        if (point == std::string::npos) {
+            return big_integer(str.substr(first, last - first));
+        }
+        return big_integer(str.substr(first, point - first) + str.substr(point + 1, last - point - 1));
+    }
+
+    big_integer from_int128(int128_t v) {
+        uint32_t limbs[4];
+        uint128_t u = static_cast<uint128_t>(v);
+        for (uint32_t& limb : limbs) {
+            limb = static_cast<uint32_t>(u);
+            u >>= 32;
+        }
+        return big_integer::from_limbs(limbs, 4, v < 0);
+    }
+
+    struct scale_total {
+        int128_t small = 0;                                         // values of at most two limbs
+        big_integer big;
+    };
+}
+
+big_decimal::big_decimal() : big_decimal(0) {}
+
+big_decimal::big_decimal(int a) : unscaled_(a), scale_(0) {}
+
+big_decimal::big_decimal(big_integer const& unscaled, size_t scale) : unscaled_(unscaled), scale_(scale) {}
+
+big_decimal::big_decimal(std::string const& str) : big_decimal() {
+    size_t first = !str.empty() && (str[0] == '-' || str[0] == '+');
+    size_t point = std::string::npos, digits = 0;
+    for (size_t pos = first; pos < str.size(); pos++) {
+        if (str[pos] == '.' && point == std::string::npos) {
+            point = pos;
+        } else if (str[pos] >= '0' && str[pos] <= '9') {
+            digits++;
+        } else {
+            throw std::invalid_argument("Invalid decimal: " + str);
+        }
+    }
+    if (digits == 0) {
+        throw std::invalid_argument("Invalid decimal: " + str);
+    }
+    scale_ = point == std::string::npos ? 0 : str.size() - point - 1;
+    unscaled_ = parse_digits(str, first, point, str.size());
+    if (str[0] == '-') {
+        unscaled_ = -unscaled_;
+    }
+}
+
+big_integer const& big_decimal::unscaled() const {
+    return unscaled_;
+}
+
+size_t big_decimal::scale() const {
+    return scale_;
+}
+
+big_decimal big_decimal::rescaled(size_t scale) const {
+    if (scale >= scale_) {
+        return big_decimal(aligned(unscaled_, scale_, scale), scale);
+    }
+    big_integer unit = big_integer_powers::ten(scale_ - scale);
+    std::pair<big_integer, big_integer> qr = divmod(unscaled_, unit);
+    big_integer twice = qr.second < 0 ? -qr.second : qr.second;
+    twice <<= 1;
+    if (twice > unit || (twice == unit && qr.first.test_bit(0))) {
+        if (unscaled_ < 0) {
+            --qr.first;
+        } else {
+            ++qr.first;
+        }
+    }
+    return big_decimal(qr.first, scale);
+}
+
+big_decimal& big_decimal::operator+=(big_decimal const& rhs) {
+    if (scale_ < rhs.scale_) {
+        unscaled_ = aligned(unscaled_, scale_, rhs.scale_);
+        scale_ = rhs.scale_;
+    }
+    if (scale_ == rhs.scale_) {
+        unscaled_ += rhs.unscaled_;
+    } else {
+        unscaled_ += aligned(rhs.unscaled_, rhs.scale_, scale_);
+    }
+    return *this;
+}
+
+big_decimal& big_decimal::operator-=(big_decimal const& rhs) {
+    if (scale_ < rhs.scale_) {
+        unscaled_ = aligned(unscaled_, scale_, rhs.scale_);
+        scale_ = rhs.scale_;
+    }
+    if (scale_ == rhs.scale_) {
+        unscaled_ -= rhs.unscaled_;
+    } else {
+        unscaled_ -= aligned(rhs.unscaled_, rhs.scale_, scale_);
+    }
+    return *this;
+}
+
+big_decimal& big_decimal::operator*=(big_decimal const& rhs) {
+    unscaled_ *= rhs.unscaled_;
+    scale_ += rhs.scale_;
+    return *this;
+}
+
+big_decimal big_decimal::operator+() const {
+    return *this;
+}
+
+big_decimal big_decimal::operator-() const {
+    return big_decimal(-unscaled_, scale_);
+}
+
+big_decimal operator+(big_decimal a, big_decimal const& b) {
+    return a += b;
+}
+
+big_decimal operator-(big_decimal a, big_decimal const& b) {
+    return a -= b;
+}
+
+big_decimal operator*(big_decimal a, big_decimal const& b) {
+    return a *= b;
+}
+
+int compare(big_decimal const& a, big_decimal const& b) {
+    size_t scale = std::max(a.scale_, b.scale_);
+    big_integer x = aligned(a.unscaled_, a.scale_, scale);
+    big_integer y = aligned(b.unscaled_, b.scale_, scale);
+    return x < y ? -1 : (y < x ? 1 : 0);
+}
+
+bool operator==(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_decimal const& a, big_decimal const& b) {
+    return compare(a, b) >= 0;
+}
+
+// an int128_t total takes 2^63 two-limb values before it can overflow, more than fit in memory
+big_decimal sum(big_decimal const* values, size_t count) {
+    std::map<size_t, scale_total> totals;
+    scale_total* last = nullptr;
+    size_t last_scale = 0;
+    for (size_t i = 0; i < count; i++) {
+        big_decimal const& value = values[i];
+        if (last == nullptr || value.scale_ != last_scale) {
+            last = &totals[value.scale_];
+            last_scale = value.scale_;
+        }
+        big_integer const& v = value.unscaled_;
+        if (v.limb_count() <= 2) {
+            uint64_t low = v.limb(0) | static_cast<uint64_t>(v.limb(1)) << 32;
+            int128_t wide = low;
+            if (v.limb(2) != 0) {
+                wide -= static_cast<int128_t>(1) << 64;
+            }
+            last->small += wide;
+        } else {
+            last->big += v;
+        }
+    }
+    if (totals.empty()) {
+        return big_decimal();
+    }
+    size_t scale = totals.rbegin()->first;
+    big_integer result;
+    for (auto& total : totals) {
+        total.second.big += from_int128(total.second.small);
+        result += aligned(total.second.big, total.first, scale);
+    }
+    return big_decimal(result, scale);
+}
+
+big_decimal sum(std::vector<big_decimal> const& values) {
+    return sum(values.data(), values.size());
+}
+
+std::string to_string(big_decimal const& a) {
+    bool negative = a.unscaled() < 0;
+    std::string digits = to_string(negative ? -a.unscaled() : a.unscaled());
+    if (a.scale() == 0) {
+        return negative ? "-" + digits : digits;
+    }
+    if (digits.size() <= a.scale()) {
+        digits.insert(0, a.scale() + 1 - digits.size(), '0');
+    }
+    digits.insert(digits.size() - a.scale(), 1, '.');
+    return negative ? "-" + digits : digits;
+}
+
+std::ostream& operator<<(std::ostream& s, big_decimal const& a) {
+    return s << to_string(a);
+}
@@ -0,0 +1,57 @@
+#ifndef BIG_DECIMAL_H
+#define BIG_DECIMAL_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <big_integer.h>
+
+// Fixed-point decimal unscaled() * 10 ^ -scale(). Sums and differences take the larger scale
+// of the operands, products the sum of the scales; nothing is rounded unless rescaled() asks for it.
+struct big_decimal {
+    big_decimal();
+    big_decimal(int a);
+    big_decimal(big_integer const& unscaled, size_t scale);
+    explicit big_decimal(std::string const& str);                   // "-123.4567", "42", ".5"
+
+    big_integer const& unscaled() const;
+    size_t scale() const;
+    big_decimal rescaled(size_t scale) const;                       // exact upwards, half to even downwards
+
+    big_decimal& operator+=(big_decimal const& rhs);
+    big_decimal& operator-=(big_decimal const& rhs);
+    big_decimal& operator*=(big_decimal const& rhs);
+
+    big_decimal operator+() const;
+    big_decimal operator-() const;
+
+    friend int compare(big_decimal const& a, big_decimal const& b);
+    friend big_decimal sum(big_decimal const* values, size_t count);
+
+ private:
+    big_integer unscaled_;
+    size_t scale_;
+};
+
+big_decimal operator+(big_decimal a, big_decimal const& b);
+big_decimal operator-(big_decimal a, big_decimal const& b);
+big_decimal operator*(big_decimal a, big_decimal const& b);
+
+int compare(big_decimal const& a, big_decimal const& b);            // by value, so 1.50 == 1.5
+bool operator==(big_decimal const& a, big_decimal const& b);
+bool operator!=(big_decimal const& a, big_decimal const& b);
+bool operator<(big_decimal const& a, big_decimal const& b);
+bool operator>(big_decimal const& a, big_decimal const& b);
+bool operator<=(big_decimal const& a, big_decimal const& b);
+bool operator>=(big_decimal const& a, big_decimal const& b);
+
+// values are summed per scale, 64-bit ones in a 128-bit accumulator; every partial sum is
+// then aligned to the largest scale once, instead of once per value
+big_decimal sum(big_decimal const* values, size_t count);
+big_decimal sum(std::vector<big_decimal> const& values);
+
+std::string to_string(big_decimal const& a);                        // exactly scale() digits after the point
+std::ostream& operator<<(std::ostream& s, big_decimal const& a);
+
+#endif // BIG_DECIMAL_H
@@ -0,0 +1,417 @@
+#include "big_float.h"
+#include "big_integer_kernels.h"
+#include "big_integer_powers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const size_t SHORT_PRODUCT_THRESHOLD = 8;                       // limbs of each operand
+    const size_t SHORT_PRODUCT_GUARD_BITS = 64;                     // exact bits kept below the precision
+
+    // a * b without the partial products a[i] * b[j], i + j < cut. They sum to less than
+    // 2 ^ {32 * (cut + 2)}, so the result is at most that much below the full product.
+    big_integer short_product(big_integer const& a, big_integer const& b, size_t cut) {
+        uint32_t const* x = a.limb_data();
+        uint32_t const* y = b.limb_data();
+        size_t na = a.limb_count(), nb = b.limb_count();
+        std::vector<uint32_t> r(na + nb, 0);
+        auto addmul_1 = big_integer_kernels::kernels().addmul_1;
+        for (size_t i = 0; i < na; i++) {                           // row i starts at limb max(cut, i)
+            size_t from = cut > i ? cut - i : 0;
+            if (from < nb) {
+                r[i + nb] = addmul_1(r.data() + i + from, y + from, nb - from, x[i]);
+            }
+        }
+        return big_integer::from_limbs(r.data(), r.size(), false);
+    }
+
+    big_integer isqrt(big_integer const& n) {                       // floor(sqrt(n)), Newton from above
+        if (n == 0) {
+            return 0;
+        }
+        big_integer x = big_integer(1) << static_cast<int>((n.bit_length() + 1) / 2);
+        while (true) {
+            big_integer y = (x + n / x) >> 1;
+            if (y >= x) {
+                return x;
+            }
+            x = std::move(y);
+        }
+    }
+
+    int64_t floor_log10_of_power_of_two(int64_t t) {
+        return static_cast<int64_t>(std::floor(static_cast<long double>(t) * 0.30102999566398119521L));
+    }
+}
+
+big_float::big_float() : negative_(false), magnitude_(0), exponent_(0), precision_(DEFAULT_PRECISION) {}
+
+big_float::big_float(double a, size_t precision) : big_float() {
+    if (!std::isfinite(a)) {
+        throw std::invalid_argument("big_float: not a finite value");
+    }
+    int k;
+    double fraction = std::frexp(std::fabs(a), &k);                 // [0.5, 1), exact in 53 bits
+    uint64_t bits = static_cast<uint64_t>(std::ldexp(fraction, 53));
+    *this = round(a < 0, big_integer(bits), k - 53, false, precision);
+}
+
+big_float::big_float(big_integer const& a, size_t precision)
+    : big_float(round(a < 0, a < 0 ? -a : a, 0, false, precision)) {}
+
+big_float::big_float(std::string const& str, size_t precision) : big_float() {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < str.size() && (str[pos] == '-' || str[pos] == '+')) {
+        negative = (str[pos++] == '-');
+    }
+    std::string digits;
+    int64_t scale = 0;                                              // value = digits * 10 ^ scale
+    bool point = false;
+    for (; pos < str.size() && str[pos] != 'e' && str[pos] != 'E'; pos++) {
+        if (str[pos] == '.' && !point) {
+            point = true;
+        } else if (str[pos] >= '0' && str[pos] <= '9') {
+            digits += str[pos];
+            scale -= point;
+        } else {
+            throw std::invalid_argument("big_float: bad number " + str);
+        }
+    }
+    if (digits.empty()) {
+        throw std::invalid_argument("big_float: bad number " + str);
+    }
+    if (pos < str.size()) {
+        size_t used = 0;
+        std::string exponent = str.substr(pos + 1);
+        long long e = exponent.empty() ? 0 : std::stoll(exponent, &used);
+        if (used == 0 || used != exponent.size()) {
+            throw std::invalid_argument("big_float: bad exponent " + str);
+        }
+        scale += e;
+    }
+    big_integer value(digits);                                      // the usual decimal parse
+    if (value == 0) {
+        precision_ = precision;
+        return;
+    }
+    if (scale >= 0) {
+        *this = round(negative, value * big_integer_powers::ten(scale), 0, false, precision);
+        return;
+    }
+    big_integer den = big_integer_powers::ten(-scale);
+    int64_t shift = static_cast<int64_t>(precision + 3 + den.bit_length()) - static_cast<int64_t>(value.bit_length());
+    shift = std::max<int64_t>(shift, 0);
+    std::pair<big_integer, big_integer> qr = divmod(value << static_cast<int>(shift), den);
+    *this = round(negative, qr.first, -shift, qr.second != 0, precision);
+}
+
+// callers pass sticky (nonzero bits below magnitude) only with at least precision + 2 bits
+big_float big_float::round(bool negative, big_integer magnitude, int64_t exponent, bool sticky, size_t precision) {
+    big_float result;
+    result.precision_ = precision;
+    if (magnitude == 0) {
+        return result;
+    }
+    size_t bits = magnitude.bit_length();
+    if (bits <= precision) {
+        magnitude <<= static_cast<int>(precision - bits);
+        exponent -= static_cast<int64_t>(precision - bits);
+    } else {
+        size_t shift = bits - precision;
+        bool half = magnitude.test_bit(shift - 1);
+        bool rest = sticky || magnitude.count_trailing_zeros() < shift - 1;
+        magnitude >>= static_cast<int>(shift);
+        exponent += static_cast<int64_t>(shift);
+        if (half && (rest || magnitude.test_bit(0))) {              // to nearest, ties to even
+            magnitude += 1;
+            if (magnitude.bit_length() > precision) {
+                magnitude >>= 1;
+                exponent++;
+            }
+        }
+    }
+    result.negative_ = negative;
+    result.magnitude_ = std::move(magnitude);
+    result.exponent_ = exponent;
+    return result;
+}
+
+size_t big_float::precision() const {
+    return precision_;
+}
+
+big_integer big_float::mantissa() const {
+    return negative_ ? -magnitude_ : magnitude_;
+}
+
+int64_t big_float::exponent() const {
+    return exponent_;
+}
+
+bool big_float::is_zero() const {
+    return magnitude_ == 0;
+}
+
+int64_t big_float::top() const {
+    return exponent_ + static_cast<int64_t>(precision_);
+}
+
+double big_float::to_double() const {
+    if (is_zero()) {
+        return 0.0;
+    }
+    big_float r = with_precision(53);
+    uint64_t m = r.magnitude_.limb(0) | (static_cast<uint64_t>(r.magnitude_.limb(1)) << 32u);
+    double result = std::ldexp(static_cast<double>(m), static_cast<int>(std::max<int64_t>(
+        std::min<int64_t>(r.exponent_, INT32_MAX), INT32_MIN)));
+    return negative_ ? -result : result;
+}
+
+big_float big_float::with_precision(size_t precision) const {
+    return round(negative_, magnitude_, exponent_, false, precision);
+}
+
+big_float big_float::add(big_float const& a, big_float const& b, bool subtract) {
+    size_t precision = std::max(a.precision_, b.precision_);
+    bool b_negative = b.negative_ != subtract;
+    if (b.is_zero()) {
+        return round(a.negative_, a.magnitude_, a.exponent_, false, precision);
+    }
+    if (a.is_zero()) {
+        return round(b_negative, b.magnitude_, b.exponent_, false, precision);
+    }
+    bool a_bigger = a.top() >= b.top();
+    big_float const& big = a_bigger ? a : b;
+    big_float const& small = a_bigger ? b : a;
+    bool big_negative = a_bigger ? a.negative_ : b_negative;
+    bool small_negative = a_bigger ? b_negative : a.negative_;
+    // below a quarter of the result's ulp the smaller operand only nudges the rounding:
+    // big * 4 +- 1 with sticky set stands for big +- something in (0, 1) at that scale
+    int64_t floor = big.top() - static_cast<int64_t>(precision) - 2;
+    if (small.top() <= floor) {
+        big_integer m = big.magnitude_ << static_cast<int>(big.exponent_ - floor);
+        if (big_negative != small_negative) {
+            m -= 1;
+        }
+        return round(big_negative, std::move(m), floor, true, precision);
+    }
+    int64_t e = std::min(a.exponent_, b.exponent_);
+    big_integer x = a.magnitude_ << static_cast<int>(a.exponent_ - e);
+    big_integer y = b.magnitude_ << static_cast<int>(b.exponent_ - e);
+    if (a.negative_) {
+        x = -x;
+    }
+    if (b_negative) {
+        y = -y;
+    }
+    x += y;
+    bool negative = x < 0;
+    return round(negative, negative ? -x : x, e, false, precision);
+}
+
+big_float& big_float::operator+=(big_float const& rhs) {
+    return *this = add(*this, rhs, false);
+}
+
+big_float& big_float::operator-=(big_float const& rhs) {
+    return *this = add(*this, rhs, true);
+}
+
+// Large operands use a short product that keeps precision + 64 exact bits. It is at most
+// 2 ^ {32 * (cut + 2)} below the full product, so if both ends of that interval round the
+// same way the result is exact; otherwise (rarely, near a tie) the full product decides.
+big_float& big_float::operator*=(big_float const& rhs) {
+    size_t precision = std::max(precision_, rhs.precision_);
+    bool negative = negative_ != rhs.negative_;
+    int64_t e = exponent_ + rhs.exponent_;
+    if (is_zero() || rhs.is_zero()) {
+        return *this = round(false, 0, 0, false, precision);
+    }
+    if (magnitude_.limb_count() >= SHORT_PRODUCT_THRESHOLD && rhs.magnitude_.limb_count() >= SHORT_PRODUCT_THRESHOLD) {
+        size_t product_bits = magnitude_.bit_length() + rhs.magnitude_.bit_length();
+        if (product_bits >= precision + SHORT_PRODUCT_GUARD_BITS + 96) {
+            size_t cut = (product_bits - precision - SHORT_PRODUCT_GUARD_BITS) / 32 - 2;
+            big_integer low = short_product(magnitude_, rhs.magnitude_, cut);
+            big_integer high = low + (big_integer(1) << static_cast<int>(32 * (cut + 2)));
+            big_float low_rounded = round(negative, std::move(low), e, false, precision);
+            big_float high_rounded = round(negative, std::move(high), e, false, precision);
+            if (low_rounded.magnitude_ == high_rounded.magnitude_ && low_rounded.exponent_ == high_rounded.exponent_) {
+                return *this = std::move(low_rounded);
+            }
+        }
+    }
+    return *this = round(negative, magnitude_ * rhs.magnitude_, e, false, precision);
+}
+
+big_float& big_float::operator/=(big_float const& rhs) {
+    if (rhs.is_zero()) {
+        throw std::overflow_error("Divide by zero exception");
+    }
+    size_t precision = std::max(precision_, rhs.precision_);
+    if (is_zero()) {
+        return *this = round(false, 0, 0, false, precision);
+    }
+    // quotient of at least precision + 3 bits, the remainder is the sticky bit
+    int64_t shift = static_cast<int64_t>(precision + 3 + rhs.precision_) - static_cast<int64_t>(precision_);
+    big_integer num = magnitude_, den = rhs.magnitude_;
+    if (shift >= 0) {
+        num <<= static_cast<int>(shift);
+    } else {
+        den <<= static_cast<int>(-shift);
+    }
+    std::pair<big_integer, big_integer> qr = divmod(num, den);
+    return *this = round(negative_ != rhs.negative_, std::move(qr.first), exponent_ - rhs.exponent_ - shift,
+                         qr.second != 0, precision);
+}
+
+big_float big_float::operator+() const {
+    return *this;
+}
+
+big_float big_float::operator-() const {
+    big_float result(*this);
+    result.negative_ = !is_zero() && !negative_;
+    return result;
+}
+
+big_float operator+(big_float a, big_float const& b) {
+    return a += b;
+}
+
+big_float operator-(big_float a, big_float const& b) {
+    return a -= b;
+}
+
+big_float operator*(big_float a, big_float const& b) {
+    return a *= b;
+}
+
+big_float operator/(big_float a, big_float const& b) {
+    return a /= b;
+}
+
+big_float sqrt(big_float const& a) {
+    if (a.negative_) {
+        throw std::invalid_argument("big_float: sqrt of a negative value");
+    }
+    if (a.is_zero()) {
+        return a;
+    }
+    // an even exponent and at least 2 * (precision + 2) bits under the root
+    int64_t shift = std::max<int64_t>(0, static_cast<int64_t>(2 * (a.precision_ + 2)) - static_cast<int64_t>(a.precision_) + 1);
+    if ((a.exponent_ - shift) % 2 != 0) {
+        shift++;
+    }
+    big_integer n = a.magnitude_ << static_cast<int>(shift);
+    big_integer root = isqrt(n);
+    bool sticky = root * root != n;
+    return big_float::round(false, std::move(root), (a.exponent_ - shift) / 2, sticky, a.precision_);
+}
+
+big_float ldexp(big_float a, int64_t k) {
+    if (!a.is_zero()) {
+        a.exponent_ += k;
+    }
+    return a;
+}
+
+int compare(big_float const& a, big_float const& b) {
+    int sa = a.is_zero() ? 0 : (a.negative_ ? -1 : 1);
+    int sb = b.is_zero() ? 0 : (b.negative_ ? -1 : 1);
+    if (sa != sb || sa == 0) {
+        return sa < sb ? -1 : (sa > sb ? 1 : 0);
+    }
+    int magnitude;
+    if (a.top() != b.top()) {
+        magnitude = a.top() < b.top() ? -1 : 1;
+    } else {
+        int64_t e = std::min(a.exponent_, b.exponent_);
+        big_integer x = a.magnitude_ << static_cast<int>(a.exponent_ - e);
+        big_integer y = b.magnitude_ << static_cast<int>(b.exponent_ - e);
+        magnitude = x < y ? -1 : (y < x ? 1 : 0);
+    }
+    return sa * magnitude;
+}
+
+bool operator==(big_float const& a, big_float const& b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_float const& a, big_float const& b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_float const& a, big_float const& b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_float const& a, big_float const& b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_float const& a, big_float const& b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_float const& a, big_float const& b) {
+    return compare(a, b) >= 0;
+}
+
+// digits = ceil(precision * log10(2)) + 1 significant digits always read back exactly
+std::string to_string(big_float const& a) {
+    if (a.is_zero()) {
+        return "0";
+    }
+    size_t digits = a.precision_ * 30103 / 100000 + 2;
+    int64_t exponent10 = floor_log10_of_power_of_two(a.top() - 1);
+    big_integer lower = big_integer_powers::ten(digits - 1), upper = lower * 10;
+    big_integer scaled;
+    while (true) {
+        int64_t p = static_cast<int64_t>(digits) - 1 - exponent10; // scaled = round(|a| * 10 ^ p)
+        big_integer num = a.magnitude_, den = 1;
+        if (p >= 0) {
+            num *= big_integer_powers::ten(p);
+        } else {
+            den = big_integer_powers::ten(-p);
+        }
+        if (a.exponent_ >= 0) {
+            num <<= static_cast<int>(a.exponent_);
+        } else {
+            den <<= static_cast<int>(-a.exponent_);
+        }
+        std::pair<big_integer, big_integer> qr = divmod(num, den);
+        scaled = std::move(qr.first);
+        big_integer twice = qr.second << 1;
+        if (twice > den || (twice == den && scaled.test_bit(0))) {
+            scaled += 1;
+        }
+        if (scaled >= upper) {
+            exponent10++;
+        } else if (scaled < lower) {
+            exponent10--;
+        } else {
+            break;
+        }
+    }
+    std::string text = to_string(scaled);
+    size_t end = text.find_last_not_of('0') + 1;
+    std::string result = a.negative_ ? "-" : "";
+    result += text[0];
+    if (end > 1) {
+        result += '.';
+        result.append(text, 1, end - 1);
+    }
+    if (exponent10 != 0) {
+        result += 'e' + std::to_string(exponent10);
+    }
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& s, big_float const& a) {
+    return s << to_string(a);
+}
@@ -0,0 +1,73 @@
+#ifndef BIG_FLOAT_H
+#define BIG_FLOAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <big_integer.h>
+
+// Binary floating point: mantissa() * 2 ^ exponent(), where |mantissa()| has exactly precision()
+// bits, or the value is zero. Every operation rounds its exact result to nearest, ties to even,
+// at the larger precision of its operands. There are no infinities or NaNs: division by zero
+// and sqrt of a negative value throw.
+struct big_float {
+    static const size_t DEFAULT_PRECISION = 64;
+
+    big_float();                                                    // zero
+    explicit big_float(double a, size_t precision = 53);
+    explicit big_float(big_integer const& a, size_t precision = DEFAULT_PRECISION);
+    big_float(std::string const& str, size_t precision);            // "-12.5", "1e100", "3.25e-7"
+
+    size_t precision() const;
+    big_integer mantissa() const;
+    int64_t exponent() const;
+    bool is_zero() const;
+    double to_double() const;
+    big_float with_precision(size_t precision) const;               // rounded to the new precision
+
+    big_float& operator+=(big_float const& rhs);
+    big_float& operator-=(big_float const& rhs);
+    big_float& operator*=(big_float const& rhs);
+    big_float& operator/=(big_float const& rhs);
+
+    big_float operator+() const;
+    big_float operator-() const;
+
+    friend big_float sqrt(big_float const& a);
+    friend big_float ldexp(big_float a, int64_t k);
+    friend int compare(big_float const& a, big_float const& b);
+    friend std::string to_string(big_float const& a);
+
+ private:
+    static big_float round(bool negative, big_integer magnitude, int64_t exponent, bool sticky, size_t precision);
+    static big_float add(big_float const& a, big_float const& b, bool subtract);
+    int64_t top() const;                                            // exponent of the bit above the mantissa
+
+    bool negative_;
+    big_integer magnitude_;
+    int64_t exponent_;
+    size_t precision_;
+};
+
+big_float operator+(big_float a, big_float const& b);
+big_float operator-(big_float a, big_float const& b);
+big_float operator*(big_float a, big_float const& b);
+big_float operator/(big_float a, big_float const& b);
+
+big_float sqrt(big_float const& a);
+big_float ldexp(big_float a, int64_t k);                            // a * 2 ^ k, exact
+
+int compare(big_float const& a, big_float const& b);                // exact, -1, 0 or 1
+bool operator==(big_float const& a, big_float const& b);
+bool operator!=(big_float const& a, big_float const& b);
+bool operator<(big_float const& a, big_float const& b);
+bool operator>(big_float const& a, big_float const& b);
+bool operator<=(big_float const& a, big_float const& b);
+bool operator>=(big_float const& a, big_float const& b);
+
+// scientific form with enough digits to read back to the same value: "1.5", "-2.5e-3", "1e100"
+std::string to_string(big_float const& a);
+std::ostream& operator<<(std::ostream& s, big_float const& a);
+
+#endif // BIG_FLOAT_H
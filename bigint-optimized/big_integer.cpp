@@ -1,16 +1,177 @@
 #include "big_integer.h"
+#include "big_integer_kernels.h"
+#include "big_integer_powers.h"
+#include "big_integer_stats.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 #include <functional>
 #include <cassert>
 #include <algorithm>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <ostream>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <immintrin.h>
 
 namespace {
-    const big_integer TEN(10), BASE(1000 * 1000 * 1000);
+    const uint32_t TEN = 10, BASE = 1000 * 1000 * 1000;
+    const divisor BASE_DIVISOR(BASE);                               // every limb of a decimal conversion divides by it
+    const size_t BASE_DIGITS = 9;
+    const size_t STREAM_BUFFER_SIZE = 4096;
+    const size_t PREINV_DIVISION_THRESHOLD = 8;                    // limbs, below it the reciprocal does not pay off
+    const size_t PARALLEL_DECIMAL_THRESHOLD = 2048;                // limbs or base 10 ^ 9 chunks, below it one thread converts
+    const size_t DECIMAL_LEAF_CHUNKS = 128;                         // converted directly at the bottom of a split
+
+    // r -= x modulo 2 ^ {32 * nr}, for nx <= nr
+    void subtract_shifted(big_integer_kernels::table const& k, uint32_t* r, size_t nr, uint32_t const* x, size_t nx) {
+        uint32_t borrow = k.sub_n(r, r, x, nx);
+        for (size_t i = nx; i < nr && borrow != 0; i++) {
+            borrow = (r[i]-- == 0);
+        }
+    }
+
+    // w[0 .. n] -= q * v[0 .. n - 1]; returns whether the result went negative
+    bool multiply_subtract(big_integer_kernels::table const& k, uint32_t* w, uint32_t const* v, size_t n, uint32_t q) {
+        uint32_t borrow = k.submul_1(w, v, n, q);
+        bool negative = w[n] < borrow;
+        w[n] -= borrow;
+        return negative;
+    }
+
+    // w[0 .. n] += v, dropping the final carry
+    void add_back(big_integer_kernels::table const& k, uint32_t* w, uint32_t const* v, size_t n) {
+        w[n] += k.add_n(w, w, v, n);
+    }
+
+    // (hi:lo) / d for a normalized d and hi < d, v = floor((2 ^ 64 - 1) / d) - 2 ^ 32
+    uint32_t divide_2_1_preinv(uint32_t hi, uint32_t lo, uint32_t d, uint32_t v, uint32_t& remainder) {
+        uint64_t q = static_cast<uint64_t>(v) * hi + ((static_cast<uint64_t>(hi) << 32u) | lo);
+        uint32_t q1 = static_cast<uint32_t>(q >> 32u) + 1;
+        uint32_t q0 = static_cast<uint32_t>(q);
+        uint32_t r = lo - q1 * d;
+        uint32_t mask = -static_cast<uint32_t>(r > q0);                 // taken half the time, so no branch
+        q1 += mask;
+        r += mask & d;
+        if (__builtin_expect(r >= d, 0)) {
+            q1++;
+            r -= d;
+        }
+        remainder = r;
+        return q1;
+    }
+
+    // q = x / (d >> s) for n limbs of x, d normalized, q may be x or nullptr; returns the remainder.
+    // The dividend is shifted left by s on the fly, which does not change the quotient.
+    uint32_t divide_limbs_preinv(uint32_t* q, uint32_t const* x, size_t n, uint32_t d, uint32_t v, unsigned s) {
+        uint32_t r = static_cast<uint32_t>(x[n - 1] >> (31 - s) >> 1);  // top s bits
+        for (size_t i = n - 1; i > 0; --i) {
+            uint64_t pair = (static_cast<uint64_t>(x[i]) << 32u) | x[i - 1];
+            uint32_t quotient = divide_2_1_preinv(r, static_cast<uint32_t>(pair >> (32 - s)), d, v, r);
+            if (q != nullptr) {
+                q[i] = quotient;
+            }
+        }
+        uint32_t quotient = divide_2_1_preinv(r, x[0] << s, d, v, r);
+        if (q != nullptr) {
+            q[0] = quotient;
+        }
+        return r >> s;
+    }
+
+    // the vector paths outside the kernel table follow the same level, so force(baseline) drops them too
+    bool use_avx2() {
+        return big_integer_kernels::allows(big_integer_kernels::level::avx2);
+    }
+
+    bool use_popcnt() {                                             // every CPU with BMI2 has POPCNT
+        return big_integer_kernels::allows(big_integer_kernels::level::bmi2_adx);
+    }
+
+    __attribute__((target("popcnt")))
+    size_t popcount_limbs_popcnt(uint32_t const* d, size_t n) {
+        size_t result = 0;
+        for (size_t i = 0; i < n; i++) {
+            result += __builtin_popcount(d[i]);
+        }
+        return result;
+    }
+
+    size_t popcount_limbs_generic(uint32_t const* d, size_t n) {
+        size_t result = 0;
+        for (size_t i = 0; i < n; i++) {
+            result += __builtin_popcount(d[i]);
+        }
+        return result;
+    }
+
+    // nibble lookup with pshufb, byte counts summed into 64-bit lanes by psadbw; returns limbs done
+    __attribute__((target("avx2")))
+    size_t popcount_limbs_avx2(uint32_t const* d, size_t n, size_t& result) {
+        __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+        __m256i total = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(d + i));
+            __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_nibbles));
+            __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return i;
+    }
+
+    size_t popcount_limbs(uint32_t const* d, size_t n) {
+        size_t result = 0;
+        size_t done = use_avx2() ? popcount_limbs_avx2(d, n, result) : 0;
+        return result + (use_popcnt() ? popcount_limbs_popcnt(d + done, n - done)
+                                      : popcount_limbs_generic(d + done, n - done));
+    }
+
+    __attribute__((target("avx2")))
+    size_t find_limb_not_equal_avx2(uint32_t const* d, size_t from, size_t n, uint32_t value) {
+        __m256i pattern = _mm256_set1_epi32(static_cast<int>(value));
+        size_t i = from;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(d + i));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(v, pattern)) != -1) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    size_t find_limb_not_equal(uint32_t const* d, size_t from, size_t n, uint32_t value) { // n if every limb is value
+        size_t i = use_avx2() ? find_limb_not_equal_avx2(d, from, n, value) : from;
+        while (i < n && d[i] == value) {
+            i++;
+        }
+        return i;
+    }
+
+    char* write_chunk(char* out, uint32_t chunk) {
+        for (size_t i = BASE_DIGITS; i > 0; --i) {
+            out[i - 1] = static_cast<char>('0' + chunk % 10);
+            chunk /= 10;
+        }
+        return out + BASE_DIGITS;
+    }
+
+    char* write_leading_chunk(char* out, uint32_t chunk) {
+        char digits[BASE_DIGITS];
+        char* end = write_chunk(digits, chunk);
+        char* first = digits;
+        while (first + 1 != end && *first == '0') {
+            ++first;
+        }
+        return std::copy(first, end, out);
+    }
 
     uint32_t divide_3_2(uint32_t u3, uint32_t u2, uint32_t u1, uint32_t d2, uint32_t d1) {
         unsigned __int128 up = u3;
@@ -25,9 +186,199 @@ namespace {
         return (c >= '0' && c <= '9');
     }
 
+    std::atomic<unsigned> requested_conversion_threads(0);
+
+    unsigned conversion_threads() {
+        static const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        unsigned requested = requested_conversion_threads.load(std::memory_order_relaxed);
+        return requested == 0 ? hardware : requested;
+    }
+
+    // low() on this thread, high() on another one when threads > 1; exceptions reach the caller either way
+    template<typename Low, typename High>
+    void fork_join(unsigned threads, Low&& low, High&& high) {
+        if (threads < 2) {
+            low();
+            high();
+            return;
+        }
+        std::future<void> forked = std::async(std::launch::async, std::forward<High>(high));
+        low();
+        forked.get();
+    }
+
+    // powers[j] = BASE ^ {DECIMAL_LEAF_CHUNKS * 2 ^ j}, j < levels, from the shared cache. Taken before a
+    // conversion fans out, then only read by its threads: copies share the limbs through the atomic
+    // reference count.
+    std::vector<big_integer> decimal_split_powers(size_t levels) {
+        std::vector<big_integer> powers;
+        size_t leaf_level = __builtin_ctzll(DECIMAL_LEAF_CHUNKS);
+        for (size_t j = 0; j < levels; j++) {
+            powers.push_back(big_integer_powers::decimal_base(leaf_level + j));
+        }
+        return powers;
+    }
+
+    size_t decimal_split_levels(size_t chunks) {                    // smallest k with DECIMAL_LEAF_CHUNKS * 2 ^ k >= chunks
+        size_t levels = 0;
+        while ((DECIMAL_LEAF_CHUNKS << levels) < chunks) {
+            levels++;
+        }
+        return levels;
+    }
+
+    // count base 10 ^ 9 chunks, least significant first, multiplied in limb by limb
+    big_integer join_chunks_direct(uint32_t const* chunks, size_t count) {
+        std::vector<uint32_t> limbs(count);                         // 10 ^ 9 < 2 ^ 32, one limb per chunk is enough
+        size_t n = 0;
+        for (size_t i = count; i > 0; --i) {
+            uint64_t carry = chunks[i - 1];
+            for (size_t j = 0; j < n; j++) {
+                uint64_t cur = static_cast<uint64_t>(limbs[j]) * BASE + carry;
+                limbs[j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32u;
+            }
+            if (carry != 0) {
+                limbs[n++] = static_cast<uint32_t>(carry);
+            }
+        }
+        return big_integer::from_limbs(limbs.data(), n, false);
+    }
+
+    // DECIMAL_LEAF_CHUNKS * 2 ^ level chunks: high half * powers[level - 1] + low half, halves in parallel
+    big_integer join_chunks(uint32_t const* chunks, size_t level, std::vector<big_integer> const& powers,
+                            unsigned threads) {
+        if (level == 0) {
+            return join_chunks_direct(chunks, DECIMAL_LEAF_CHUNKS);
+        }
+        size_t half = DECIMAL_LEAF_CHUNKS << (level - 1);
+        big_integer low, high;
+        fork_join(threads,
+                  [&] { low = join_chunks(chunks, level - 1, powers, threads - threads / 2); },
+                  [&] { high = join_chunks(chunks + half, level - 1, powers, threads / 2); });
+        high *= powers[level - 1];
+        return high += low;
+    }
+
     const auto AND_ = [](uint32_t a, uint32_t b) { return a & b; };
     const auto OR_ = [](uint32_t a, uint32_t b) { return a | b; };
     const auto XOR_ = [](uint32_t a, uint32_t b) { return a ^ b; };
+
+    const char DIGIT_CHARS[] = "0123456789abcdefghijklmnopqrstuv";
+
+    unsigned power_of_two_base_bits(int base) {
+        switch (base) {
+            case 2: return 1;
+            case 8: return 3;
+            case 16: return 4;
+            case 32: return 5;
+            default: throw std::invalid_argument("Unsupported base: " + std::to_string(base));
+        }
+    }
+
+    uint32_t digit_value(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A' + 10;
+        }
+        return UINT32_MAX;
+    }
+
+    const uint8_t NEGATIVE_FLAG = 1u;
+
+    const uint64_t HASH_MUL = 0x9e3779b97f4a7c15ull;
+    const size_t HASH_LANES = 4;
+
+    uint64_t hash_finalize(uint64_t h) {
+        h ^= h >> 33u;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33u;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33u;
+        return h;
+    }
+
+    uint64_t hash_limbs(uint32_t const* d, size_t n) {
+        // independent lanes over 64-bit words, so the main loop has no cross-iteration dependency chain
+        uint64_t lanes[HASH_LANES] = {1, 2, 3, 4};
+        size_t i = 0;
+        for (; i + 2 * HASH_LANES <= n; i += 2 * HASH_LANES) {
+            for (size_t j = 0; j < HASH_LANES; j++) {
+                uint64_t word = d[i + 2 * j] | (static_cast<uint64_t>(d[i + 2 * j + 1]) << 32u);
+                lanes[j] = (lanes[j] ^ word) * HASH_MUL;
+                lanes[j] ^= lanes[j] >> 32u;
+            }
+        }
+        uint64_t h = n;
+        for (size_t j = 0; j < HASH_LANES; j++) {
+            h = (h ^ lanes[j]) * HASH_MUL;
+        }
+        for (; i < n; i++) {
+            h = (h ^ d[i]) * HASH_MUL;
+            h ^= h >> 32u;
+        }
+        return h;
+    }
+
+    size_t varint_size(uint64_t value) {
+        size_t size = 1;
+        while (value >= 0x80u) {
+            value >>= 7u;
+            size++;
+        }
+        return size;
+    }
+
+    uint8_t* write_varint(uint8_t* out, uint64_t value) {
+        while (value >= 0x80u) {
+            *out++ = static_cast<uint8_t>(value | 0x80u);
+            value >>= 7u;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    uint8_t const* read_varint(uint8_t const* in, uint8_t const* end, uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; in != end && shift < 64; shift += 7) {
+            uint8_t byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+            if (!(byte & 0x80u)) {
+                return in;
+            }
+        }
+        throw std::invalid_argument("Malformed big_integer length prefix");
+    }
+
+    void store_limbs(uint8_t* out, uint32_t const* limbs, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(out, limbs, n * sizeof(uint32_t));
+#else
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < sizeof(uint32_t); j++) {
+                *out++ = static_cast<uint8_t>(limbs[i] >> (8u * j));
+            }
+        }
+#endif
+    }
+
+    void load_limbs(uint32_t* limbs, uint8_t const* in, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(limbs, in, n * sizeof(uint32_t));
+#else
+        for (size_t i = 0; i < n; i++) {
+            limbs[i] = 0;
+            for (size_t j = 0; j < sizeof(uint32_t); j++) {
+                limbs[i] |= static_cast<uint32_t>(*in++) << (8u * j);
+            }
+        }
+#endif
+    }
 }
 
 big_integer::big_integer() : sign_(0), digits_(1, 0) {}
@@ -54,6 +405,7 @@ big_integer& big_integer::operator=(big_integer&& other)  noexcept {
 }
 
 big_integer::big_integer(std::string const& str) : sign_(0), digits_(1, 0) {
+    BIGINT_STATS_OP(parse, str.size() / 9 + 1);
     assert(!str.empty());
     bool result_positive = true;
     if (str[0] == '-') {
@@ -61,175 +413,312 @@ big_integer::big_integer(std::string const& str) : sign_(0), digits_(1, 0) {
     } else {
         assert(str[0] == '+' || is_digit(str[0]));
     }
-    for (size_t pos = !is_digit(str[0]); pos < str.size(); ++pos) {
-        assert(is_digit(str[pos]));
-        *this = *this * TEN + (str[pos] - '0');
+    size_t first = !is_digit(str[0]);
+    assert(first < str.size());
+    std::vector<uint32_t> chunks((str.size() - first + BASE_DIGITS - 1) / BASE_DIGITS);
+    for (size_t i = 0, end = str.size(); i < chunks.size(); i++, end -= BASE_DIGITS) {
+        uint32_t chunk = 0;
+        for (size_t pos = end - first > BASE_DIGITS ? end - BASE_DIGITS : first; pos < end; ++pos) {
+            assert(is_digit(str[pos]));
+            chunk = chunk * TEN + static_cast<uint32_t>(str[pos] - '0');
+        }
+        chunks[i] = chunk;
+    }
+    if (chunks.size() < PARALLEL_DECIMAL_THRESHOLD) {
+        *this = join_chunks_direct(chunks.data(), chunks.size());
+    } else {
+        size_t levels = decimal_split_levels(chunks.size());
+        chunks.resize(DECIMAL_LEAF_CHUNKS << levels, 0);
+        *this = join_chunks(chunks.data(), levels, decimal_split_powers(levels), conversion_threads());
     }
     if (!result_positive) {
         fast_negate();
     }
 }
 
-void big_integer::shrink_to_fit() {
-    while (digits_.size() > 1 && digits_.back() == sign_) {
-        digits_.pop_back();
+big_integer::big_integer(std::string const& str, int base) : sign_(0), digits_(1, 0) {
+    if (base == 10) {
+        *this = big_integer(str);
+        return;
+    }
+    unsigned k = power_of_two_base_bits(base);
+    assert(!str.empty());
+    size_t first = (str[0] == '-' || str[0] == '+');
+    assert(first < str.size());
+    size_t bits = (str.size() - first) * k;
+    BIGINT_STATS_OP(parse, bits / 32 + 1);
+    digits_ = vector((bits + 31) / 32 + 1, 0);
+    uint32_t* d = digits_.data();
+    size_t pos = 0;
+    for (size_t i = str.size(); i > first; --i, pos += k) {
+        uint32_t value = digit_value(str[i - 1]);
+        assert(value < static_cast<uint32_t>(base));
+        d[pos / 32] |= value << (pos % 32);
+        if (pos % 32 + k > 32) {
+            d[pos / 32 + 1] |= value >> (32 - pos % 32);
+        }
+    }
+    shrink_to_fit();
+    if (str[0] == '-') {
+        fast_negate();
     }
 }
 
-big_integer& big_integer::operator+=(big_integer const& rhs) {
-    size_t max_size = 1 + std::max(digits_.size(), rhs.digits_.size());
-    digits_.resize(max_size, sign_);
-    uint64_t carry = 0;
-    for (size_t i = 0; i < rhs.digits_.size(); i++) {
-        uint64_t new_carry = ((digits_[i] + carry + rhs.digits_[i]) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + rhs.digits_[i]);
-        carry = new_carry;
+size_t big_integer::limb_count() const {
+    return digits_.size();
+}
+
+uint32_t big_integer::limb(size_t idx) const {
+    return idx < digits_.size() ? digits_[idx] : sign_;
+}
+
+uint32_t const* big_integer::limb_data() const {
+    return digits_.data();
+}
+
+big_integer big_integer::from_limbs(uint32_t const* limbs, size_t n, bool negative) {
+    big_integer result;
+    result.sign_ = negative ? UINT32_MAX : 0;
+    if (n == 0) {
+        result.digits_[0] = result.sign_;
+        return result;
     }
-    for (size_t i = rhs.digits_.size(); i < max_size; i++) {
-        uint64_t new_carry = ((digits_[i] + carry + rhs.sign_) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + rhs.sign_);
-        carry = new_carry;
+    result.digits_ = vector(n, 0);
+    std::copy(limbs, limbs + n, result.digits_.data());
+    result.shrink_to_fit();
+    return result;
+}
+
+void big_integer::shrink_to_fit() {
+    uint32_t const* d = static_cast<vector const&>(digits_).data();
+    size_t n = digits_.size();
+    while (n > 1 && d[n - 1] == sign_) {
+        n--;
     }
-    sign_ = (digits_.back() & (~1u)) ? UINT32_MAX : 0;
-    shrink_to_fit();
+    if (n != digits_.size()) {
+        digits_.truncate(n);
+    }
+}
+
+big_integer& big_integer::operator+=(big_integer const& rhs) {
+    add_or_subtract(*this, rhs, false);
     return *this;
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
-    size_t max_size = 1 + std::max(digits_.size(), rhs.digits_.size());
-    digits_.resize(max_size, sign_);
-    uint64_t carry = 1u;
-    for (size_t i = 0; i < rhs.digits_.size(); i++) {
-        uint64_t new_carry = ((digits_[i] + carry + ~rhs.digits_[i]) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + ~rhs.digits_[i]);
-        carry = new_carry;
-    }
-    for (size_t i = rhs.digits_.size(); i < max_size; i++) {
-        uint64_t new_carry = ((digits_[i] + carry + ~rhs.sign_) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + ~rhs.sign_);
-        carry = new_carry;
-    }
-    sign_ = (digits_.back() & (~1u)) ? UINT32_MAX : 0;
-    shrink_to_fit();
+    add_or_subtract(*this, rhs, true);
     return *this;
 }
 
 big_integer& big_integer::operator*=(big_integer&& rhs) {
-    bool positive_result = true;
-    if (rhs.sign_ != 0) {
-        positive_result = false;
-        rhs.fast_negate();
-    }
-    *this *= rhs;
-    return positive_result ? *this : fast_negate();
+    return *this *= static_cast<big_integer const&>(rhs);
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) {
-    bool result_positive = (rhs.sign_ == sign_);
-    if (rhs.sign_ != 0) {
-        *this *= -rhs;
-        return fast_negate();
+    BIGINT_STATS_OP(mul, std::max(digits_.size(), rhs.digits_.size()));
+    int shift = rhs.power_of_two_exponent();
+    if (shift >= 0) {
+        bool negative = (rhs.sign_ != 0);
+        shift_left(shift);
+        return negative ? fast_negate() : *this;
     }
-    if (sign_ != 0) {
-        fast_negate();
+    shift = power_of_two_exponent();
+    if (shift >= 0) {
+        bool negative = (sign_ != 0);
+        *this = rhs;
+        shift_left(shift);
+        return negative ? fast_negate() : *this;
     }
-    size_t new_sz = digits_.size() + rhs.digits_.size();
-    vector new_d(new_sz, 0);
-    for (size_t i = 0; i < digits_.size(); i++) {
-        uint32_t carry = 0;
-        for (size_t j = 0; j < rhs.digits_.size(); ++j) {
-            uint64_t cur =
-                new_d[i + j]
-                + static_cast<uint64_t>(digits_[i]) * rhs.digits_[j]
-                + carry;
-            new_d[i + j] = static_cast<uint32_t>(cur);
-            carry = static_cast<uint32_t>(cur >> 32u);
-        }
-        new_d[i + rhs.digits_.size()] = carry;
-    }
-    digits_.swap(new_d);
-    if (!result_positive) {
-        fast_negate();
+    multiply(*this, rhs);
+    return *this;
+}
+
+void big_integer::add_or_subtract(big_integer const& a, big_integer const& b, bool subtract) { // *this = a +- b
+    BIGINT_STATS_OP_ADD_SUB(subtract, std::max(a.digits_.size(), b.digits_.size()));
+    size_t n = 1 + std::max(a.digits_.size(), b.digits_.size());
+    if (this == &a || this == &b) {
+        digits_.resize(n, sign_);                                   // keeps the aliased value intact
+    } else {
+        digits_.assign(n, 0);
+    }
+    uint32_t* r = digits_.data();
+    uint32_t const* x = a.digits_.data();
+    uint32_t const* y = b.digits_.data();
+    size_t nx = a.digits_.size(), ny = b.digits_.size();
+    uint32_t flip = subtract ? UINT32_MAX : 0;                      // a - b = a + ~b + 1
+    uint32_t sx = a.sign_, sy = b.sign_ ^ flip;
+    size_t i = std::min(nx, ny);
+    big_integer_kernels::table const& k = big_integer_kernels::kernels();
+    uint64_t carry = subtract ? 1 - k.sub_n(r, x, y, i) : k.add_n(r, x, y, i); // no borrow is a carry of ~b + 1
+    for (; i < nx; i++) {
+        uint64_t cur = carry + x[i] + sy;
+        r[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32u;
+    }
+    for (; i < ny; i++) {
+        uint64_t cur = carry + sx + (y[i] ^ flip);
+        r[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32u;
+    }
+    for (; i < n; i++) {
+        uint64_t cur = carry + sx + sy;
+        r[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32u;
     }
+    sign_ = (r[n - 1] >> 31u) ? UINT32_MAX : 0;
+    shrink_to_fit();
+}
+
+void big_integer::multiply(big_integer const& a, big_integer const& b) { // *this = a * b
+    if (this == &a || this == &b) {
+        big_integer result;
+        result.multiply(a, b);
+        *this = std::move(result);
+        return;
+    }
+    size_t na = a.digits_.size(), nb = b.digits_.size(), n = na + nb + 1;
+    digits_.assign(n, 0);
+    uint32_t* r = digits_.data();
+    uint32_t const* x = a.digits_.data();
+    uint32_t const* y = b.digits_.data();
+    big_integer_kernels::table const& k = big_integer_kernels::kernels();
+    r[nb] = k.mul_1(r, y, nb, x[0]);
+    for (size_t i = 1; i < na; i++) {
+        r[i + nb] = k.addmul_1(r + i, y, nb, x[i]);
+    }
+    // digits are the value plus 2 ^ {32 * size} for negatives: drop those terms modulo 2 ^ {32 * n}
+    if (a.sign_ != 0) {
+        subtract_shifted(k, r + na, n - na, y, nb);
+    }
+    if (b.sign_ != 0) {
+        subtract_shifted(k, r + nb, n - nb, x, na);
+    }
+    if (a.sign_ != 0 && b.sign_ != 0) {
+        r[n - 1]++;
+    }
+    sign_ = (r[n - 1] >> 31u) ? UINT32_MAX : 0;
     shrink_to_fit();
-    return *this;
+}
+
+void add(big_integer& dst, big_integer const& a, big_integer const& b) {
+    dst.add_or_subtract(a, b, false);
+}
+
+void sub(big_integer& dst, big_integer const& a, big_integer const& b) {
+    dst.add_or_subtract(a, b, true);
+}
+
+void mul(big_integer& dst, big_integer const& a, big_integer const& b) {
+    BIGINT_STATS_OP(mul, std::max(a.digits_.size(), b.digits_.size()));
+    dst.multiply(a, b);
 }
 
 ////////////////////////////////////////////////////////////////////////// DIV
 
 big_integer& big_integer::divide_n_1(uint32_t rhs) {
+    divmod_n_1(rhs);
+    return *this;
+}
+
+uint32_t big_integer::divmod_n_1(uint32_t rhs) {  // for non-negative values, returns the remainder
+    uint32_t* d = digits_.data();
     uint64_t carry = 0;
-    for (ptrdiff_t i = (ptrdiff_t) digits_.size() - 1; i >= 0; --i) {
-        uint64_t cur = digits_[i] + (carry << 32u);
-        digits_[i] = static_cast<uint32_t>(cur / rhs);
-        carry = static_cast<uint32_t>(cur % rhs);
+    for (size_t i = digits_.size(); i > 0; --i) {
+        uint64_t cur = d[i - 1] | (carry << 32u);
+        d[i - 1] = static_cast<uint32_t>(cur / rhs);
+        carry = cur % rhs;
     }
     shrink_to_fit();
-    return *this;
+    return static_cast<uint32_t>(carry);
 }
 
-big_integer& big_integer::subtract_power(big_integer const& rhs,
-                                         size_t power) { // result = *this - rhs * 2 ^ {32 * power}
-    size_t max_size = 1 + std::max(digits_.size(), rhs.digits_.size() + power);
-    digits_.resize(max_size, sign_);
-    uint64_t carry = 1u;
-    for (size_t i = 0; i < power; i++) {
-        uint64_t new_carry = ((digits_[i] + carry + UINT32_MAX) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + UINT32_MAX);
-        carry = new_carry;
+divisor::divisor(uint32_t value) : value_(value) {
+    if (value == 0) {
+        throw std::overflow_error("Divide by zero exception");
     }
-    for (size_t i = power; i < rhs.digits_.size() + power; i++) {
-        uint64_t new_carry = ((digits_[i] + carry + ~rhs.digits_[i - power]) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + ~rhs.digits_[i - power]);
-        carry = new_carry;
+    shift_ = __builtin_clz(value);
+    normalized_ = value << shift_;
+    reciprocal_ = static_cast<uint32_t>(UINT64_MAX / normalized_ - (uint64_t(1) << 32u));
+}
+
+uint32_t divisor::value() const {
+    return value_;
+}
+
+big_integer& big_integer::divide_n_1(divisor const& rhs) {
+    divmod_n_1(rhs);
+    return *this;
+}
+
+uint32_t big_integer::divmod_n_1(divisor const& rhs) {  // for non-negative values, returns the remainder
+    uint32_t* d = digits_.data();
+    uint32_t r = divide_limbs_preinv(d, d, digits_.size(), rhs.normalized_, rhs.reciprocal_, rhs.shift_);
+    shrink_to_fit();
+    return r;
+}
+
+uint32_t big_integer::remainder_n_1(divisor const& rhs) const {
+    if (sign_ != 0) {
+        return (-*this).remainder_n_1(rhs);
     }
-    for (size_t i = rhs.digits_.size() + power; i < max_size; i++) {
-        uint64_t new_carry = ((digits_[i] + carry + ~rhs.sign_) >> 32u);
-        digits_[i] = static_cast<uint32_t>(digits_[i] + carry + ~rhs.sign_);
-        carry = new_carry;
+    return divide_limbs_preinv(nullptr, digits_.data(), digits_.size(), rhs.normalized_, rhs.reciprocal_, rhs.shift_);
+}
+
+big_integer& big_integer::operator/=(divisor const& rhs) {
+    BIGINT_STATS_OP(div, digits_.size());
+    bool negative = (sign_ != 0);
+    if (negative) {
+        fast_negate();
     }
-    sign_ = (digits_.back() & (~1u)) ? UINT32_MAX : 0;
-    shrink_to_fit();
-    return *this;
+    divide_n_1(rhs);
+    return negative ? fast_negate() : *this;
 }
 
-big_integer& big_integer::divide_m_n(big_integer const& rhs) {
+big_integer& big_integer::operator%=(divisor const& rhs) {
+    BIGINT_STATS_OP(mod, digits_.size());
+    bool negative = (sign_ != 0);
+    *this = remainder_n_1(rhs);
+    return negative ? fast_negate() : *this;
+}
+
+// Knuth's algorithm D on the limbs in place: *this and rhs are non-negative, rhs is normalized
+big_integer& big_integer::divide_m_n(big_integer const& rhs, big_integer* remainder) {
     assert(digits_.size() >= 3 && rhs.digits_.size() >= 2);
     size_t n = rhs.digits_.size();
-    size_t k = digits_.size() - n;
-    vector new_d(k + 1, 0);
-    if (*this >= (rhs << static_cast<int>(32u * k))) {
-        new_d[k] = 1;
-        subtract_power(rhs, k);
-    } else {
-        new_d[k] = 0;
-    }
-    while (k > 0) {
-        if (digits_.size() < rhs.digits_.size()) {
-            break;
-        }
-        k--;
-        uint32_t u3 = digits_[n + k], u2 = digits_[n + k - 1], u1 = digits_[n + k - 2];
-        uint32_t d2 = rhs.digits_[n - 1], d1 = rhs.digits_[n - 2];
-        if (((static_cast<uint64_t>(u3) << 32u) | u2) == ((static_cast<uint64_t>(d2) << 32u) | d1)) {
-            new_d[k] = UINT32_MAX;
-        } else {
-            new_d[k] = divide_3_2(u3, u2, u1, d2, d1);
-        }
-        subtract_power(rhs * new_d[k], k);
-        while (*this < 0) {
-            *this += rhs;
-            --new_d[k];
+    size_t m = digits_.size() - n;
+    digits_.push_back(0);                                           // the quotient may take m + 1 limbs
+    uint32_t* u = digits_.data();
+    uint32_t const* v = rhs.digits_.data();
+    uint32_t d1 = v[n - 1], d0 = v[n - 2];
+    vector quotient(m + 1, 0);
+    uint32_t* q = quotient.data();
+    big_integer_kernels::table const& k = big_integer_kernels::kernels();
+    for (size_t j = m + 1; j > 0; --j) {
+        uint32_t* w = u + (j - 1);                                  // the window u[j - 1 .. j + n - 1]
+        uint32_t u2 = w[n], u1 = w[n - 1], u0 = w[n - 2];
+        uint32_t qhat = (u2 == d1 && u1 == d0) ? UINT32_MAX : divide_3_2(u2, u1, u0, d1, d0);
+        if (multiply_subtract(k, w, v, n, qhat)) {                  // at most one too big
+            add_back(k, w, v, n);
+            qhat--;
         }
+        q[j - 1] = qhat;
+    }
+    if (remainder != nullptr) {
+        *remainder = from_limbs(u, n, false);
     }
-    digits_.swap(new_d);
+    digits_.swap(quotient);
     shrink_to_fit();
     return *this;
 }
 
-big_integer& big_integer::divide_unsigned_normalized(big_integer const& rhs) {
+big_integer& big_integer::divide_unsigned_normalized(big_integer const& rhs, big_integer* remainder) {
     if (rhs.digits_.size() == 1) {
-        return divide_n_1(rhs.digits_[0]);
+        uint32_t r = digits_.size() >= PREINV_DIVISION_THRESHOLD ? divmod_n_1(divisor(rhs.digits_[0]))
+                                                                 : divmod_n_1(rhs.digits_[0]);
+        if (remainder != nullptr) {
+            *remainder = r;
+        }
+        return *this;
     }
     if (digits_.size() == 2) {
         uint64_t u = digits_[1];
@@ -238,131 +727,301 @@ big_integer& big_integer::divide_unsigned_normalized(big_integer const& rhs) {
         if (rhs.digits_.size() == 2) {
             v |= static_cast<uint64_t>(rhs.digits_[1]) << 32u;
         }
+        if (remainder != nullptr) {
+            *remainder = u % v;
+        }
         return *this = u / v;
     }
-    return divide_m_n(rhs);
+    return divide_m_n(rhs, remainder);
 }
 
-big_integer& big_integer::divide_unsigned(big_integer& rhs) {
+big_integer& big_integer::divide_unsigned(big_integer& rhs, big_integer* remainder) {
     if (digits_.size() < rhs.digits_.size()) {
+        if (remainder != nullptr) {
+            *remainder = *this;
+        }
         return *this = 0;
     }
     int clz = __builtin_clz(rhs.digits_.back());
     if (clz) {
-        *this <<= clz;
-        return divide_unsigned_normalized(rhs <<= clz);
+        shift_left(clz);
+        divide_unsigned_normalized(rhs.shift_left(clz), remainder);
+        if (remainder != nullptr) {
+            remainder->shift_right(clz);
+        }
+        return *this;
     } else {
-        return divide_unsigned_normalized(rhs);
+        return divide_unsigned_normalized(rhs, remainder);
     }
 }
 
-big_integer& big_integer::operator/=(big_integer rhs) {
+big_integer& big_integer::keep_low_bits(size_t bits) {  // for non-negative values, *this mod 2 ^ bits
+    size_t words = bits / 32u;
+    if (words >= digits_.size()) {
+        return *this;
+    }
+    while (digits_.size() > words + 1) {
+        digits_.pop_back();
+    }
+    digits_[words] &= (1u << (bits % 32u)) - 1;
+    shrink_to_fit();
+    return *this;
+}
+
+void big_integer::divide_truncated(big_integer rhs, big_integer* remainder) {
     if (rhs == 0) {
         throw std::overflow_error("Divide by zero exception");
     }
     bool result_positive = (rhs.sign_ == sign_);
-    if (rhs.sign_ != 0) {
-        rhs.fast_negate();
-    }
+    bool dividend_negative = (sign_ != 0);
     if (sign_ != 0) {
         fast_negate();
     }
-    big_integer copy_rhs(rhs);
-    *this = divide_unsigned(copy_rhs);
+    int shift = rhs.power_of_two_exponent();
+    if (shift >= 0) {                                               // |*this| >> shift truncates towards zero
+        if (remainder != nullptr) {
+            *remainder = *this;
+            remainder->keep_low_bits(shift);
+        }
+        shift_right(shift);
+    } else {
+        if (rhs.sign_ != 0) {
+            rhs.fast_negate();
+        }
+        divide_unsigned(rhs, remainder);
+    }
     if (!result_positive) {
         fast_negate();
     }
+    if (remainder != nullptr && dividend_negative) {
+        remainder->fast_negate();                                   // takes the sign of the dividend
+    }
+}
+
+big_integer& big_integer::operator/=(big_integer rhs) {
+    BIGINT_STATS_OP(div, std::max(digits_.size(), rhs.digits_.size()));
+    divide_truncated(std::move(rhs), nullptr);
     return *this;
 }
 
 big_integer& big_integer::operator%=(big_integer const& rhs) {
-    return *this -= (*this / rhs) * rhs;
+    BIGINT_STATS_OP(mod, std::max(digits_.size(), rhs.digits_.size()));
+    *this = remainder(*this, rhs);
+    return *this;
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b, division_rounding rounding) {
+    std::pair<big_integer, big_integer> result(a, 0);
+    big_integer& q = result.first;
+    big_integer& r = result.second;
+    q.divide_truncated(b, &r);
+    if (rounding == division_rounding::floor && r != 0 && r.sign_ != b.sign_) {
+        --q;
+        r += b;
+    }
+    return result;
+}
+
+big_integer remainder(big_integer const& a, big_integer const& b, division_rounding rounding) {
+    return divmod(a, b, rounding).second;
+}
+
+namespace {
+    const size_t LEHMER_BITS = 62;                                  // leading parts, so x + A and y + C fit an int64_t
+
+    uint64_t bits_from(big_integer const& a, size_t shift) {        // low 64 bits of a >> shift for a >= 0
+        size_t idx = shift / 32;
+        unsigned offset = shift % 32;
+        uint64_t low = a.limb(idx) | static_cast<uint64_t>(a.limb(idx + 1)) << 32u;
+        if (offset == 0) {
+            return low;
+        }
+        return low >> offset | static_cast<uint64_t>(a.limb(idx + 2)) << (64 - offset);
+    }
+
+    // r = u * x - v * y over n limbs, for a result known to lie in [0, 2 ^ {32 * n}); r may equal x
+    void combine(big_integer_kernels::table const& k, uint32_t* r, uint32_t const* x, uint32_t u,
+                 uint32_t const* y, uint32_t v, size_t n) {
+        k.mul_1(r, x, n, u);
+        k.submul_1(r, y, n, v);                                     // the carry and the borrow cancel
+    }
+}
+
+// Lehmer's algorithm (Knuth, TAOCP 4.5.2, algorithm L): a run of Euclidean steps is found on the
+// leading LEHMER_BITS of a and b alone, while both bounds on the true quotient agree and the
+// cofactors fit a limb, then applied to the full operands at once, four single-limb
+// multiplications per run of about 32 bits instead of a division per quotient
+big_integer gcd(big_integer a, big_integer b) {
+    if (a < 0) {
+        a.fast_negate();
+    }
+    if (b < 0) {
+        b.fast_negate();
+    }
+    if (a < b) {
+        std::swap(a, b);
+    }
+    big_integer_kernels::table const& k = big_integer_kernels::kernels();
+    big_integer next;
+    while (b != 0) {                                                // a >= b > 0
+        size_t bits = a.bit_length();
+        if (bits <= 64) {
+            uint64_t x = bits_from(a, 0), y = bits_from(b, 0);
+            while (y != 0) {
+                x %= y;
+                std::swap(x, y);
+            }
+            return big_integer(x);
+        }
+        size_t shift = bits - LEHMER_BITS;
+        int64_t x = static_cast<int64_t>(bits_from(a, shift)), y = static_cast<int64_t>(bits_from(b, shift));
+        int64_t A = 1, B = 0, C = 0, D = 1;                         // signs alternate: A, D >= 0 >= B, C or the reverse
+        while (y + C > 0 && y + D > 0) {
+            int64_t q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D)) {
+                break;
+            }
+            int64_t c = A - q * C, d = B - q * D;
+            if (std::max(std::abs(c), std::abs(d)) > UINT32_MAX) {
+                break;
+            }
+            A = C;
+            C = c;
+            B = D;
+            D = d;
+            int64_t t = x - q * y;
+            x = y;
+            y = t;
+        }
+        if (B == 0) {                                               // not even one step is certain: divide in full
+            a %= b;
+            std::swap(a, b);
+            continue;
+        }
+        size_t n = a.digits_.size();
+        b.digits_.resize(n, 0);
+        next.digits_.assign(n, 0);
+        uint32_t* pa = a.digits_.data();
+        uint32_t* pb = b.digits_.data();
+        if (B < 0) {                                                // a' = A a - |B| b, b' = D b - |C| a
+            combine(k, next.digits_.data(), pa, A, pb, -B, n);
+            combine(k, pb, pb, D, pa, -C, n);
+        } else {                                                    // a' = B b - |A| a, b' = C a - |D| b
+            combine(k, next.digits_.data(), pb, B, pa, -A, n);
+            combine(k, pa, pa, C, pb, -D, n);
+            std::swap(a, b);
+        }
+        std::swap(a, next);
+        a.shrink_to_fit();
+        b.shrink_to_fit();
+    }
+    return a;
 }
 
 ////////////////////////////////////////////////////////////////////////// DIV_END
 
-void big_integer::bit_operation(big_integer const& rhs, std::function<uint32_t(uint32_t, uint32_t)> const& f) {
+void big_integer::bit_operation(big_integer const& rhs, bit_kernel op, std::function<uint32_t(uint32_t, uint32_t)> const& f) {
     if (digits_.size() < rhs.digits_.size()) {
         digits_.resize(rhs.digits_.size(), sign_);
     }
-    for (size_t i = 0; i < digits_.size(); ++i) {
-        uint32_t cur = i < rhs.digits_.size() ? rhs.digits_[i] : rhs.sign_;
-        digits_[i] = f(digits_[i], cur);
+    size_t common = rhs.digits_.size();
+    uint32_t* d = digits_.data();
+    op(d, d, rhs.digits_.data(), common);
+    uint32_t if_zero = f(0, rhs.sign_), if_one = f(UINT32_MAX, rhs.sign_); // f is bitwise, rhs.sign_ all zeros or ones
+    for (size_t i = common; i < digits_.size(); ++i) {
+        d[i] = (d[i] & if_one) | (~d[i] & if_zero);
     }
     sign_ = f(sign_, rhs.sign_);
+    shrink_to_fit();
 }
 
 big_integer& big_integer::operator&=(big_integer const& rhs) {
-    bit_operation(rhs, AND_);
+    BIGINT_STATS_OP(bit_and, std::max(digits_.size(), rhs.digits_.size()));
+    bit_operation(rhs, big_integer_kernels::kernels().and_n, AND_);
     return *this;
 }
 
 big_integer& big_integer::operator|=(big_integer const& rhs) {
-    bit_operation(rhs, OR_);
+    BIGINT_STATS_OP(bit_or, std::max(digits_.size(), rhs.digits_.size()));
+    bit_operation(rhs, big_integer_kernels::kernels().or_n, OR_);
     return *this;
 }
 
 big_integer& big_integer::operator^=(big_integer const& rhs) {
-    bit_operation(rhs, XOR_);
+    BIGINT_STATS_OP(bit_xor, std::max(digits_.size(), rhs.digits_.size()));
+    bit_operation(rhs, big_integer_kernels::kernels().xor_n, XOR_);
     return *this;
 }
 
 big_integer& big_integer::operator<<=(int rhs) {
+    BIGINT_STATS_OP(shl, digits_.size());
+    assert(rhs >= 0);
+    return shift_left(rhs);
+}
+
+big_integer& big_integer::operator>>=(int rhs) {
+    BIGINT_STATS_OP(shr, digits_.size());
     assert(rhs >= 0);
+    return shift_right(rhs);
+}
+
+big_integer& big_integer::shift_left(int rhs) {
     if (rhs == 0) {
         return *this;
     }
-    digits_.resize(
-        digits_.size() + rhs / (32u) + 1,
-        sign_);
-    if (rhs / (32u) != 0) {
-        for (size_t i = digits_.size(); i > 0; --i) {
-            ptrdiff_t pos_from = static_cast<ptrdiff_t>(i - 1) - rhs / (32u);
-            digits_[i - 1] = (pos_from >= 0 ? digits_[pos_from] : 0);
-        }
-    }
-    if (rhs % (32u) != 0) {
-        for (size_t i = digits_.size(); i > 0; --i) {
-            uint32_t next = (i < 2 ? 0 : digits_[i - 2]);
-            uint32_t cur = digits_[i - 1];
-            digits_[i - 1] =
-                static_cast<uint32_t>((((
-                    static_cast<uint64_t>(cur) << 32u) | next)
-                    <<
-                    static_cast<uint64_t>(rhs % 32u))
-                    >> 32u);
-        }
+    size_t words = rhs / 32u;
+    unsigned bits = rhs % 32u;
+    size_t m = digits_.size() + 1, n = m + words;                   // the sign limb on top takes the bits shifted out
+    digits_.resize(n, sign_);
+    uint32_t* d = digits_.data();
+    if (bits == 0) {
+        std::copy_backward(d, d + m, d + n);
+    } else {
+        big_integer_kernels::kernels().lshift(d + words, d, m, bits);
     }
+    std::fill(d, d + words, 0);
     shrink_to_fit();
     return *this;
 }
 
-big_integer& big_integer::operator>>=(int rhs) {
-    assert(rhs >= 0);
+big_integer& big_integer::shift_right(int rhs) {
     if (rhs == 0) {
         return *this;
     }
-    if (rhs / (32u) != 0) {
-        for (size_t i = 0; i < digits_.size(); i++) {
-            size_t pos_from = i + rhs / (32u);
-            digits_[i] = (pos_from < digits_.size() ? digits_[pos_from] : sign_);
-        }
-    }
-    uint32_t prev = sign_;
-    if (rhs % (32u) != 0) {
-        for (size_t i = digits_.size(); i > 0; --i) {
-            uint32_t cur = digits_[i - 1];
-            digits_[i - 1] = static_cast<uint32_t>((
-                (static_cast<uint64_t>(prev) << 32u) | cur)
-                >>
-                static_cast<uint32_t>(rhs % (32u)));
-            prev = cur;
+    size_t words = rhs / 32u;
+    unsigned bits = rhs % 32u;
+    size_t n = digits_.size();
+    uint32_t* d = digits_.data();
+    if (words < n) {
+        if (bits == 0) {
+            std::copy(d + words, d + n, d);
+        } else {
+            big_integer_kernels::kernels().rshift(d, d + words, n - words, bits);
+            d[n - words - 1] |= sign_ << (32 - bits);               // limbs past the top are sign_
         }
     }
+    std::fill(d + (n - std::min(words, n)), d + n, sign_);
     shrink_to_fit();
     return *this;
 }
 
+int big_integer::power_of_two_exponent() const {
+    uint32_t const* d = digits_.data();
+    size_t n = digits_.size(), i = 0;
+    while (i < n && d[i] == 0) {
+        i++;
+    }
+    if (i == n) {
+        return sign_ != 0 ? static_cast<int>(32 * n) : -1;          // -2 ^ {32 * n} or zero
+    }
+    uint32_t v = d[i];
+    bool single = (sign_ != 0) ? (v | (v - 1)) == UINT32_MAX : (v & (v - 1)) == 0;
+    for (size_t j = i + 1; single && j < n; j++) {
+        single = (d[j] == sign_);
+    }
+    return single ? static_cast<int>(32 * i + __builtin_ctz(v)) : -1;
+}
+
 big_integer big_integer::operator+() const {
     return *this;
 }
@@ -431,6 +1090,14 @@ big_integer operator%(big_integer a, big_integer const& b) {
     return a %= b;
 }
 
+big_integer operator/(big_integer a, divisor const& b) {
+    return a /= b;
+}
+
+big_integer operator%(big_integer a, divisor const& b) {
+    return a %= b;
+}
+
 big_integer operator&(big_integer a, big_integer const& b) {
     return a &= b;
 }
@@ -461,7 +1128,8 @@ bool operator!=(big_integer const& a, big_integer const& b) {
 
 bool operator<(big_integer const& a, big_integer const& b) {
     if (a.sign_ ^ b.sign_) return a.sign_;
-    if (a.digits_.size() != b.digits_.size()) return (a.digits_.size() < b.digits_.size());
+    if (a.digits_.size() != b.digits_.size()) return a.sign_ ? (a.digits_.size() > b.digits_.size())
+                                                              : (a.digits_.size() < b.digits_.size());
     for (ptrdiff_t i = a.digits_.size() - 1; i >= 0; --i) {
         if (a.digits_[i] != b.digits_[i]) {
             return (a.digits_[i] < b.digits_[i]);
@@ -482,34 +1150,172 @@ bool operator>=(big_integer const& a, big_integer const& b) {
     return !(a < b);
 }
 
+std::vector<uint32_t> big_integer::decimal_chunks() const {
+    big_integer abs(*this);                                         // shares the limbs until the first division
+    if (abs.sign_ != 0) {
+        abs.fast_negate();
+    }
+    size_t bound = abs.digits_.size() * 32 / 29 + 1;                // 10 ^ 9 > 2 ^ 29
+    std::vector<uint32_t> chunks;
+    if (abs.digits_.size() < PARALLEL_DECIMAL_THRESHOLD) {
+        chunks.reserve(bound);
+        do {
+            chunks.push_back(abs.divmod_n_1(BASE_DIVISOR));
+        } while (abs != 0);
+        return chunks;
+    }
+    size_t levels = decimal_split_levels(bound);
+    chunks.assign(DECIMAL_LEAF_CHUNKS << levels, 0);
+    split_decimal(std::move(abs), chunks.data(), levels, decimal_split_powers(levels), conversion_threads());
+    while (chunks.size() > 1 && chunks.back() == 0) {
+        chunks.pop_back();
+    }
+    return chunks;
+}
+
+// the quotient and remainder by powers[level - 1] are the high and low halves of the chunks, converted
+// in parallel; |x| < BASE ^ {DECIMAL_LEAF_CHUNKS * 2 ^ level}, out is zeroed
+void big_integer::split_decimal(big_integer x, uint32_t* out, size_t level, std::vector<big_integer> const& powers,
+                                unsigned threads) {
+    if (level == 0) {
+        for (size_t i = 0; x != 0; i++) {
+            out[i] = x.divmod_n_1(BASE_DIVISOR);
+        }
+        return;
+    }
+    if (x < powers[level - 1]) {                                    // the high half stays zero
+        split_decimal(std::move(x), out, level - 1, powers, threads);
+        return;
+    }
+    std::pair<big_integer, big_integer> qr = divmod(x, powers[level - 1]);
+    size_t half = DECIMAL_LEAF_CHUNKS << (level - 1);
+    fork_join(threads,
+              [&] { split_decimal(std::move(qr.second), out, level - 1, powers, threads - threads / 2); },
+              [&] { split_decimal(std::move(qr.first), out + half, level - 1, powers, threads / 2); });
+}
+
+namespace {
+    // text of the conversion, handed to write in pieces of at most STREAM_BUFFER_SIZE bytes
+    template<typename Write>
+    struct chunk_writer {
+        Write& write;
+        char buffer[STREAM_BUFFER_SIZE];
+        char* out = buffer;
+
+        void put(uint32_t chunk, bool leading) {
+            if (out + BASE_DIGITS > buffer + STREAM_BUFFER_SIZE) {
+                flush();
+            }
+            out = leading ? write_leading_chunk(out, chunk) : write_chunk(out, chunk);
+        }
+
+        void flush() {
+            write(buffer, out - buffer);
+            out = buffer;
+        }
+    };
+}
+
+// chunks of |x| < BASE ^ {DECIMAL_LEAF_CHUNKS * 2 ^ level}, most significant first: the high half by
+// powers[level - 1] is written before the low half is touched, zero padded unless leading
+template<typename Writer>
+void big_integer::write_split(big_integer x, size_t level, std::vector<big_integer> const& powers, bool leading,
+                              Writer& writer) {
+    if (level == 0) {
+        uint32_t leaf[DECIMAL_LEAF_CHUNKS];
+        size_t count = 0;
+        for (; count < DECIMAL_LEAF_CHUNKS && (!leading || count == 0 || x != 0); count++) {
+            leaf[count] = (x != 0 ? x.divmod_n_1(BASE_DIVISOR) : 0);
+        }
+        for (size_t i = count; i > 0; --i) {
+            writer.put(leaf[i - 1], leading && i == count);
+        }
+        return;
+    }
+    if (leading && x < powers[level - 1]) {                         // no digits in the high half
+        write_split(std::move(x), level - 1, powers, true, writer);
+        return;
+    }
+    std::pair<big_integer, big_integer> qr = divmod(x, powers[level - 1]);
+    x = big_integer();
+    write_split(std::move(qr.first), level - 1, powers, leading, writer);
+    write_split(std::move(qr.second), level - 1, powers, false, writer);
+}
+
+template<typename Write>
+void big_integer::write_decimal(Write&& write) const {
+    BIGINT_STATS_OP(to_string, digits_.size());
+    chunk_writer<Write> writer{write};
+    big_integer abs(*this);
+    if (abs.sign_ != 0) {
+        abs.fast_negate();
+        *writer.out++ = '-';
+    }
+    if (abs.digits_.size() < PARALLEL_DECIMAL_THRESHOLD) {
+        std::vector<uint32_t> chunks = abs.decimal_chunks();
+        writer.put(chunks.back(), true);
+        for (size_t i = chunks.size() - 1; i > 0; --i) {
+            writer.put(chunks[i - 1], false);
+        }
+    } else {
+        size_t levels = decimal_split_levels(abs.digits_.size() * 32 / 29 + 1);
+        write_split(std::move(abs), levels, decimal_split_powers(levels), true, writer);
+    }
+    writer.flush();
+}
+
+void set_decimal_conversion_threads(unsigned threads) {
+    requested_conversion_threads.store(threads, std::memory_order_relaxed);
+}
+
 std::string to_string(big_integer const& rhs) {
-    if (rhs == 0) {
-        return "0";
+    BIGINT_STATS_OP(to_string, rhs.digits_.size());
+    std::vector<uint32_t> chunks = rhs.decimal_chunks();
+    std::string result(rhs.sign_ != 0, '-');
+    result.reserve(result.size() + chunks.size() * BASE_DIGITS);
+    char digits[BASE_DIGITS];
+    result.append(digits, write_leading_chunk(digits, chunks.back()));
+    for (size_t i = chunks.size() - 1; i > 0; --i) {
+        result.append(digits, write_chunk(digits, chunks[i - 1]));
     }
-    big_integer copy(rhs);
-    bool result_positive = true;
-    if (copy.sign_) {
-        result_positive = false;
-        copy.fast_negate();
+    return result;
+}
+
+size_t big_integer::magnitude_bit_length() const { // only for non-negative values
+    size_t top = digits_.size() - 1;
+    return digits_[top] == 0 ? 0 : 32 * top + (32 - __builtin_clz(digits_[top]));
+}
+
+std::string to_string(big_integer const& a, int base) {
+    if (base == 10) {
+        return to_string(a);
     }
-    std::string ans;
-    while (copy != 0) {
-        std::stringstream cur;
-        std::string tmp;
-        cur << std::setfill('0') << std::setw(9) << std::to_string((copy % BASE).digits_[0]);
-        cur >> tmp;
-        std::reverse(tmp.begin(), tmp.end());
-        ans += tmp;
-        copy /= BASE;
+    BIGINT_STATS_OP(to_string, a.digits_.size());
+    unsigned k = power_of_two_base_bits(base);
+    if (a == 0) {
+        return "0";
     }
-    while (ans.size() > 1 && ans.back() == '0') {
-        ans.pop_back();
+    bool negative = (a.sign_ != 0);
+    big_integer negated;
+    if (negative) {
+        negated = a;
+        negated.fast_negate();
     }
-    if (!result_positive) {
-        ans.push_back('-');
+    big_integer const& abs = negative ? negated : a;                // const, so reading the limbs does not unshare them
+    size_t n = abs.digits_.size();
+    uint32_t const* d = abs.digits_.data();
+    size_t length = (abs.magnitude_bit_length() + k - 1) / k;
+    uint32_t mask = (1u << k) - 1;
+    std::string result(negative + length, '-');
+    char* out = &result[result.size()];
+    for (size_t i = 0, pos = 0; i < length; ++i, pos += k) {
+        uint64_t window = d[pos / 32];
+        if (pos / 32 + 1 < n) {
+            window |= static_cast<uint64_t>(d[pos / 32 + 1]) << 32u;
+        }
+        *--out = DIGIT_CHARS[(window >> (pos % 32)) & mask];
     }
-    std::reverse(ans.begin(), ans.end());
-    return ans;
+    return result;
 }
 
 big_integer& big_integer::bit_not() {
@@ -525,6 +1331,194 @@ big_integer& big_integer::fast_negate() {
     return add_one();
 }
 
+size_t std::hash<big_integer>::operator()(big_integer const& a) const {
+    size_t result;
+    if (a.digits_.get_cached_hash(result)) {
+        return result;
+    }
+    result = static_cast<size_t>(hash_finalize(hash_limbs(a.digits_.data(), a.digits_.size()) ^ a.sign_));
+    if (result == 0) {
+        result = 1;
+    }
+    a.digits_.set_cached_hash(result);
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////// BITS
+
+size_t big_integer::bit_length() const {
+    uint32_t const* d = digits_.data();
+    for (size_t i = digits_.size(); i > 0; --i) {
+        uint32_t w = d[i - 1] ^ sign_;
+        if (w != 0) {
+            return 32 * (i - 1) + (32 - __builtin_clz(w));
+        }
+    }
+    return 0;
+}
+
+size_t big_integer::popcount() const {
+    size_t ones = popcount_limbs(digits_.data(), digits_.size());
+    return sign_ == 0 ? ones : 32 * digits_.size() - ones;
+}
+
+bool big_integer::test_bit(size_t idx) const {
+    return (limb(idx / 32) >> (idx % 32)) & 1u;
+}
+
+big_integer& big_integer::set_bit(size_t idx) {
+    if (test_bit(idx)) {
+        return *this;
+    }
+    size_t word = idx / 32;
+    if (word >= digits_.size()) {
+        digits_.resize(word + 1, sign_);                            // only non-negative values get here
+    }
+    digits_.data()[word] |= 1u << (idx % 32);
+    shrink_to_fit();
+    return *this;
+}
+
+big_integer& big_integer::clear_bit(size_t idx) {
+    if (!test_bit(idx)) {
+        return *this;
+    }
+    size_t word = idx / 32;
+    if (word >= digits_.size()) {
+        digits_.resize(word + 1, sign_);                            // only negative values get here
+    }
+    digits_.data()[word] &= ~(1u << (idx % 32));
+    shrink_to_fit();
+    return *this;
+}
+
+size_t big_integer::count_trailing_zeros() const {
+    return scan1(0);
+}
+
+size_t big_integer::scan1(size_t from) const {
+    uint32_t const* d = digits_.data();
+    size_t n = digits_.size(), word = from / 32;
+    if (word >= n) {
+        return sign_ != 0 ? from : npos;
+    }
+    uint32_t first = d[word] & (UINT32_MAX << (from % 32));
+    if (first != 0) {
+        return 32 * word + __builtin_ctz(first);
+    }
+    size_t i = find_limb_not_equal(d, word + 1, n, 0);
+    if (i < n) {
+        return 32 * i + __builtin_ctz(d[i]);
+    }
+    return sign_ != 0 ? 32 * n : npos;
+}
+
+size_t big_integer::scan0(size_t from) const {
+    uint32_t const* d = digits_.data();
+    size_t n = digits_.size(), word = from / 32;
+    if (word >= n) {
+        return sign_ == 0 ? from : npos;
+    }
+    uint32_t first = ~d[word] & (UINT32_MAX << (from % 32));
+    if (first != 0) {
+        return 32 * word + __builtin_ctz(first);
+    }
+    size_t i = find_limb_not_equal(d, word + 1, n, UINT32_MAX);
+    if (i < n) {
+        return 32 * i + __builtin_ctz(~d[i]);
+    }
+    return sign_ == 0 ? 32 * n : npos;
+}
+
+////////////////////////////////////////////////////////////////////////// BYTES
+
+size_t encoded_size(big_integer const& a, limb_encoding encoding) { // upper bound, exact for two's complement
+    // |a| needs one more limb than a only for a = -2 ^ {32 * n}
+    size_t n = a.digits_.size() + (encoding == limb_encoding::magnitude && a.sign_ != 0);
+    return varint_size(n) + 1 + n * sizeof(uint32_t);
+}
+
+size_t to_bytes(big_integer const& a, uint8_t* out, size_t capacity, limb_encoding encoding) {
+    if (encoding == limb_encoding::magnitude && a.sign_ != 0) {
+        big_integer abs(a);
+        abs.fast_negate();
+        size_t written = to_bytes(abs, out, capacity, encoding);
+        out[varint_size(abs.digits_.size())] = NEGATIVE_FLAG;
+        return written;
+    }
+    size_t n = a.digits_.size();
+    size_t size = varint_size(n) + 1 + n * sizeof(uint32_t);
+    if (capacity < size) {
+        throw std::length_error("Buffer is too small for big_integer");
+    }
+    out = write_varint(out, n);
+    *out++ = (a.sign_ != 0) ? NEGATIVE_FLAG : 0;
+    store_limbs(out, a.digits_.data(), n);
+    return size;
+}
+
+std::vector<uint8_t> to_bytes(big_integer const& a, limb_encoding encoding) {
+    std::vector<uint8_t> result(encoded_size(a, encoding));
+    result.resize(to_bytes(a, result.data(), result.size(), encoding));
+    return result;
+}
+
+limb_view view_bytes(uint8_t const* data, size_t size) {
+    uint8_t const* end = data + size;
+    uint64_t n;
+    uint8_t const* it = read_varint(data, end, n);
+    if (it == end || (*it & ~NEGATIVE_FLAG) != 0) {
+        throw std::invalid_argument("Malformed big_integer flags");
+    }
+    bool negative = (*it++ & NEGATIVE_FLAG) != 0;
+    if (n > static_cast<uint64_t>(end - it) / sizeof(uint32_t)) {
+        throw std::invalid_argument("Truncated big_integer limbs");
+    }
+    uint32_t const* limbs = nullptr;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (reinterpret_cast<uintptr_t>(it) % alignof(uint32_t) == 0) {
+        limbs = reinterpret_cast<uint32_t const*>(it);
+    }
+#endif
+    return {limbs, static_cast<size_t>(n), negative, static_cast<size_t>(it - data) + n * sizeof(uint32_t)};
+}
+
+big_integer from_bytes(uint8_t const* data, size_t size, limb_encoding encoding, size_t* consumed) {
+    limb_view view = view_bytes(data, size);
+    size_t n = view.count;
+    big_integer result;
+    if (n != 0) {
+        result.digits_ = vector(n, 0);
+        load_limbs(result.digits_.data(), data + view.consumed - n * sizeof(uint32_t), n);
+    }
+    if (encoding == limb_encoding::twos_complement) {
+        result.sign_ = view.negative ? UINT32_MAX : 0;
+        if (n == 0) {
+            result.digits_[0] = result.sign_;
+        }
+        result.shrink_to_fit();
+    } else {
+        result.shrink_to_fit();
+        if (view.negative) {
+            result.fast_negate();
+        }
+    }
+    if (consumed != nullptr) {
+        *consumed = view.consumed;
+    }
+    return result;
+}
+
+big_integer from_bytes(std::vector<uint8_t> const& bytes, limb_encoding encoding) {
+    return from_bytes(bytes.data(), bytes.size(), encoding, nullptr);
+}
+
 std::ostream& operator<<(std::ostream& s, big_integer const& a) {
-    return s << to_string(a);
+    if (s.width() != 0) {                                           // padding needs the full length up front
+        return s << to_string(a);
+    }
+    a.write_decimal([&s](char const* data, size_t size) {
+        s.write(data, static_cast<std::streamsize>(size));
+    });
+    return s;
 }
@@ -7,6 +7,44 @@
 #include <cstdint>
 #include <vector.h>
 #include <functional>
+#include <utility>
+#include <vector>
+
+struct big_integer;
+
+namespace std {
+template<>
+struct hash<big_integer> {
+    size_t operator()(big_integer const& a) const;                  // cached in the shared block of big values
+};
+}
+
+// binary layout: varint limb count, flag byte (bit 0 -- negative), little-endian 32-bit limbs
+enum class limb_encoding : uint8_t {
+    twos_complement,                                                // limbs are digits_ as is, flag is the sign word
+    magnitude                                                       // limbs are |a|, flag is the sign of a
+};
+
+// single-limb divisor with a precomputed reciprocal (Moller, Granlund, "Improved division by
+// invariant integers"): each limb of the dividend costs a multiplication and a correction, not a div
+struct divisor {
+    explicit divisor(uint32_t value);                               // throws on zero
+
+    uint32_t value() const;
+
+ private:
+    uint32_t value_;
+    uint32_t normalized_;                                           // value_ << shift_, top bit set
+    uint32_t reciprocal_;                                           // floor((2 ^ 64 - 1) / normalized_) - 2 ^ 32
+    unsigned shift_;
+
+    friend struct big_integer;
+};
+
+enum class division_rounding : uint8_t {
+    truncate,                                                       // quotient towards zero, remainder has the sign of a
+    floor                                                           // quotient towards -inf, remainder has the sign of b
+};
 
 struct big_integer {
     big_integer();
@@ -16,6 +54,7 @@ struct big_integer {
     big_integer(uint32_t a);
     big_integer(uint64_t a);
     explicit big_integer(std::string const& str);
+    big_integer(std::string const& str, int base);                  // base is 10 or one of 2, 8, 16, 32
     ~big_integer() = default;
 
     big_integer& operator=(big_integer const& other) = default;
@@ -27,6 +66,8 @@ struct big_integer {
     big_integer& operator*=(big_integer const& rhs);
     big_integer& operator/=(big_integer rhs);
     big_integer& operator%=(big_integer const& rhs);
+    big_integer& operator/=(divisor const& rhs);                   // truncates, like the big_integer overloads
+    big_integer& operator%=(divisor const& rhs);
 
     big_integer& operator&=(big_integer const& rhs);
     big_integer& operator|=(big_integer const& rhs);
@@ -45,6 +86,23 @@ struct big_integer {
     big_integer& operator--();
     big_integer operator--(int);
 
+    // two's complement limbs: limb(i) past limb_count() is the sign word
+    size_t limb_count() const;
+    uint32_t limb(size_t idx) const;
+    uint32_t const* limb_data() const;                              // limb_count() limbs, valid until *this changes
+    static big_integer from_limbs(uint32_t const* limbs, size_t n, bool negative);
+
+    // two's complement bits: a negative value has ones at every index past its top limb
+    static constexpr size_t npos = SIZE_MAX;
+    size_t bit_length() const;                                      // without the sign bit, 0 for 0 and -1
+    size_t popcount() const;                                        // bits that differ from the sign bit
+    bool test_bit(size_t idx) const;
+    big_integer& set_bit(size_t idx);
+    big_integer& clear_bit(size_t idx);
+    size_t count_trailing_zeros() const;                            // npos for zero
+    size_t scan1(size_t from) const;                                // lowest 1 bit at or above from, npos if none
+    size_t scan0(size_t from) const;                                // lowest 0 bit at or above from, npos if none
+
     friend bool operator==(big_integer const& a, big_integer const& b);
     friend bool operator!=(big_integer const& a, big_integer const& b);
     friend bool operator<(big_integer const& a, big_integer const& b);
@@ -53,18 +111,57 @@ struct big_integer {
     friend bool operator>=(big_integer const& a, big_integer const& b);
 
     friend std::string to_string(big_integer const& a);
+    friend std::string to_string(big_integer const& a, int base);
+    friend std::ostream& operator<<(std::ostream& s, big_integer const& a);
+
+    friend void add(big_integer& dst, big_integer const& a, big_integer const& b);
+    friend void sub(big_integer& dst, big_integer const& a, big_integer const& b);
+    friend void mul(big_integer& dst, big_integer const& a, big_integer const& b);
+
+    friend std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b,
+                                                      division_rounding rounding);
+    friend big_integer gcd(big_integer a, big_integer b);
+
+    friend struct std::hash<big_integer>;
+    friend struct big_accumulator;
+
+    friend size_t encoded_size(big_integer const& a, limb_encoding encoding);
+    friend size_t to_bytes(big_integer const& a, uint8_t* out, size_t capacity, limb_encoding encoding);
+    friend big_integer from_bytes(uint8_t const* data, size_t size, limb_encoding encoding, size_t* consumed);
 
  private:
+    typedef void (*bit_kernel)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
     void shrink_to_fit();
-    void bit_operation(big_integer const& rhs, std::function<uint32_t(uint32_t, uint32_t)> const& f);
-    big_integer& divide_unsigned(big_integer& rhs);
-    big_integer& divide_unsigned_normalized(big_integer const& rhs);
-    big_integer& divide_m_n(big_integer const& rhs);
+    void add_or_subtract(big_integer const& a, big_integer const& b, bool subtract);
+    void multiply(big_integer const& a, big_integer const& b);
+    void bit_operation(big_integer const& rhs, bit_kernel op, std::function<uint32_t(uint32_t, uint32_t)> const& f);
+    void divide_truncated(big_integer rhs, big_integer* remainder);  // remainder may be nullptr
+    big_integer& divide_unsigned(big_integer& rhs, big_integer* remainder);
+    big_integer& divide_unsigned_normalized(big_integer const& rhs, big_integer* remainder);
+    big_integer& divide_m_n(big_integer const& rhs, big_integer* remainder);
+    big_integer& keep_low_bits(size_t bits);
+    big_integer& shift_left(int rhs);                               // the bodies of <<= and >>=, not counted by the stats
+    big_integer& shift_right(int rhs);
     big_integer& divide_n_1(uint32_t rhs);
+    big_integer& divide_n_1(divisor const& rhs);
+    uint32_t divmod_n_1(uint32_t rhs);
+    uint32_t divmod_n_1(divisor const& rhs);
+    uint32_t remainder_n_1(divisor const& rhs) const;               // of |*this|, leaves the value untouched
     big_integer& add_one();
     big_integer& bit_not();
     big_integer& fast_negate();
-    big_integer& subtract_power(big_integer const& rhs, size_t power);
+    size_t magnitude_bit_length() const;
+    int power_of_two_exponent() const;                              // k if |*this| = 2 ^ k, -1 otherwise
+    std::vector<uint32_t> decimal_chunks() const;                   // base 10 ^ 9 digits of |*this|, least significant first
+    static void split_decimal(big_integer x, uint32_t* out, size_t level, std::vector<big_integer> const& powers,
+                              unsigned threads);
+    template<typename Writer>
+    static void write_split(big_integer x, size_t level, std::vector<big_integer> const& powers, bool leading,
+                            Writer& writer);
+    // most significant first, through a fixed buffer; the split keeps the pending low halves, O(n) limbs
+    template<typename Write>
+    void write_decimal(Write&& write) const;
 
  private:
     uint32_t sign_;
@@ -77,6 +174,21 @@ big_integer operator-(big_integer a, big_integer const& b);
 big_integer operator*(big_integer a, big_integer const& b);
 big_integer operator/(big_integer a, big_integer const& b);
 big_integer operator%(big_integer a, big_integer const& b);
+big_integer operator/(big_integer a, divisor const& b);
+big_integer operator%(big_integer a, divisor const& b);
+
+// quotient and remainder of one division, a == q * b + r
+std::pair<big_integer, big_integer> divmod(big_integer const& a, big_integer const& b,
+                                           division_rounding rounding = division_rounding::truncate);
+big_integer remainder(big_integer const& a, big_integer const& b,
+                      division_rounding rounding = division_rounding::truncate);
+// non-negative, gcd(0, 0) == 0
+big_integer gcd(big_integer a, big_integer b);
+
+// dst = a op b, reusing the storage of dst; dst may alias a or b
+void add(big_integer& dst, big_integer const& a, big_integer const& b);
+void sub(big_integer& dst, big_integer const& a, big_integer const& b);
+void mul(big_integer& dst, big_integer const& a, big_integer const& b);
 
 big_integer operator&(big_integer a, big_integer const& b);
 big_integer operator|(big_integer a, big_integer const& b);
@@ -93,6 +205,31 @@ bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
 std::string to_string(big_integer const& a);
+std::string to_string(big_integer const& a, int base);
+
+// threads one decimal parse or to_string of a huge number splits across, 0 -- one per hardware thread
+void set_decimal_conversion_threads(unsigned threads);
+
+size_t encoded_size(big_integer const& a, limb_encoding encoding = limb_encoding::twos_complement);
+size_t to_bytes(big_integer const& a, uint8_t* out, size_t capacity,
+                limb_encoding encoding = limb_encoding::twos_complement);
+std::vector<uint8_t> to_bytes(big_integer const& a, limb_encoding encoding = limb_encoding::twos_complement);
+big_integer from_bytes(uint8_t const* data, size_t size,
+                       limb_encoding encoding = limb_encoding::twos_complement, size_t* consumed = nullptr);
+big_integer from_bytes(std::vector<uint8_t> const& bytes, limb_encoding encoding = limb_encoding::twos_complement);
+
+// an encoding read in place: limbs points into the buffer when the host is little-endian and the
+// limbs start 4-byte aligned, so they can be used without decoding; otherwise it is nullptr and
+// from_bytes has to copy them out. Throws like from_bytes on malformed input.
+struct limb_view {
+    uint32_t const* limbs;
+    size_t count;
+    bool negative;                                                  // the flag byte
+    size_t consumed;                                                // bytes of the whole encoding
+};
+
+limb_view view_bytes(uint8_t const* data, size_t size);
+
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
 
 #endif // BIG_INTEGER_H
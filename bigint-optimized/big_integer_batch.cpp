@@ -0,0 +1,257 @@
+#include "big_integer_batch.h"
+#include "big_integer_kernels.h"
+
+#include <cassert>
+#include <immintrin.h>
+
+namespace {
+    const size_t AVX2_LANES = 8;
+
+    bool use_avx2() {                                               // follows big_integer_kernels::force
+        return big_integer_kernels::allows(big_integer_kernels::level::avx2);
+    }
+
+    void add_lanes(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                   size_t width, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < width; j++) {
+                uint64_t cur = carry + a[j][i] + b[j][i];
+                dst[j][i] = static_cast<uint32_t>(cur);
+                carry = cur >> 32u;
+            }
+        }
+    }
+
+    void sub_lanes(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                   size_t width, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            uint64_t carry = 1;
+            for (size_t j = 0; j < width; j++) {
+                uint64_t cur = carry + a[j][i] + static_cast<uint32_t>(~b[j][i]);
+                dst[j][i] = static_cast<uint32_t>(cur);
+                carry = cur >> 32u;
+            }
+        }
+    }
+
+    void mul_lanes(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                   size_t wa, size_t wb, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            for (size_t k = 0; k < wa + wb; k++) {
+                dst[k][i] = 0;
+            }
+            for (size_t x = 0; x < wa; x++) {
+                uint64_t carry = 0;
+                for (size_t y = 0; y < wb; y++) {
+                    uint64_t cur = dst[x + y][i] + static_cast<uint64_t>(a[x][i]) * b[y][i] + carry;
+                    dst[x + y][i] = static_cast<uint32_t>(cur);
+                    carry = cur >> 32u;
+                }
+                dst[x + wb][i] = static_cast<uint32_t>(carry);
+            }
+        }
+    }
+
+    void compare_lanes(int8_t* result, uint32_t const* const* a, uint32_t const* const* b,
+                       size_t width, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            result[i] = 0;
+            for (size_t j = width; j > 0 && result[i] == 0; --j) {
+                if (a[j - 1][i] != b[j - 1][i]) {
+                    result[i] = a[j - 1][i] < b[j - 1][i] ? -1 : 1;
+                }
+            }
+        }
+    }
+
+    // unsigned a > b for every 32-bit lane
+    __attribute__((target("avx2")))
+    __m256i greater_epu32(__m256i a, __m256i b) {
+        __m256i bias = _mm256_set1_epi32(INT32_MIN);
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+    }
+
+    __attribute__((target("avx2")))
+    size_t add_lanes_avx2(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                          size_t width, size_t count) {
+        size_t i = 0;
+        for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+            __m256i carry = _mm256_setzero_si256();
+            for (size_t j = 0; j < width; j++) {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a[j] + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b[j] + i));
+                __m256i sum = _mm256_add_epi32(va, vb);
+                __m256i with_carry = _mm256_add_epi32(sum, carry);
+                __m256i overflow = _mm256_or_si256(greater_epu32(va, sum), greater_epu32(sum, with_carry));
+                carry = _mm256_srli_epi32(overflow, 31);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst[j] + i), with_carry);
+            }
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    size_t sub_lanes_avx2(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                          size_t width, size_t count) {
+        size_t i = 0;
+        for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+            __m256i borrow = _mm256_setzero_si256();
+            for (size_t j = 0; j < width; j++) {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a[j] + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b[j] + i));
+                __m256i diff = _mm256_sub_epi32(va, vb);
+                __m256i with_borrow = _mm256_sub_epi32(diff, borrow);
+                __m256i underflow = _mm256_or_si256(greater_epu32(vb, va), greater_epu32(borrow, diff));
+                borrow = _mm256_srli_epi32(underflow, 31);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst[j] + i), with_borrow);
+            }
+        }
+        return i;
+    }
+
+    // four integers per step: 32x32->64 products in the 64-bit lanes, columns kept unpacked in scratch
+    __attribute__((target("avx2")))
+    size_t mul_lanes_avx2(uint32_t* const* dst, uint32_t const* const* a, uint32_t const* const* b,
+                          size_t wa, size_t wb, size_t count) {
+        const size_t lanes = 4;
+        std::vector<uint64_t> scratch(lanes * (wa + wb));
+        __m256i* columns = reinterpret_cast<__m256i*>(scratch.data());
+        __m256i low_mask = _mm256_set1_epi64x(UINT32_MAX);
+        size_t i = 0;
+        for (; i + lanes <= count; i += lanes) {
+            for (size_t k = 0; k < wa + wb; k++) {
+                _mm256_storeu_si256(columns + k, _mm256_setzero_si256());
+            }
+            for (size_t x = 0; x < wa; x++) {
+                __m256i va = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<__m128i const*>(a[x] + i)));
+                __m256i carry = _mm256_setzero_si256();
+                for (size_t y = 0; y < wb; y++) {
+                    __m256i vb = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b[y] + i)));
+                    __m256i cur = _mm256_add_epi64(_mm256_add_epi64(_mm256_loadu_si256(columns + x + y), carry),
+                                                   _mm256_mul_epu32(va, vb));
+                    _mm256_storeu_si256(columns + x + y, _mm256_and_si256(cur, low_mask));
+                    carry = _mm256_srli_epi64(cur, 32);
+                }
+                _mm256_storeu_si256(columns + x + wb, carry);
+            }
+            __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            for (size_t k = 0; k < wa + wb; k++) {
+                __m256i packed = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(columns + k), pack);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[k] + i), _mm256_castsi256_si128(packed));
+            }
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    size_t compare_lanes_avx2(int8_t* result, uint32_t const* const* a, uint32_t const* const* b,
+                              size_t width, size_t count) {
+        size_t i = 0;
+        for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+            __m256i less = _mm256_setzero_si256(), greater = _mm256_setzero_si256();
+            for (size_t j = width; j > 0; --j) {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a[j - 1] + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b[j - 1] + i));
+                __m256i undecided = _mm256_cmpeq_epi32(_mm256_or_si256(less, greater), _mm256_setzero_si256());
+                less = _mm256_or_si256(less, _mm256_and_si256(undecided, greater_epu32(vb, va)));
+                greater = _mm256_or_si256(greater, _mm256_and_si256(undecided, greater_epu32(va, vb)));
+            }
+            alignas(32) int32_t values[AVX2_LANES];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(values),
+                               _mm256_sub_epi32(_mm256_srli_epi32(greater, 31), _mm256_srli_epi32(less, 31)));
+            for (size_t k = 0; k < AVX2_LANES; k++) {
+                result[i + k] = static_cast<int8_t>(values[k]);
+            }
+        }
+        return i;
+    }
+
+    std::vector<uint32_t const*> rows(big_integer_batch const& batch) {
+        std::vector<uint32_t const*> result(batch.width());
+        for (size_t j = 0; j < batch.width(); j++) {
+            result[j] = batch.row(j);
+        }
+        return result;
+    }
+
+    std::vector<uint32_t*> rows(big_integer_batch& batch) {
+        std::vector<uint32_t*> result(batch.width());
+        for (size_t j = 0; j < batch.width(); j++) {
+            result[j] = batch.row(j);
+        }
+        return result;
+    }
+}
+
+big_integer_batch::big_integer_batch(size_t count, size_t width)
+    : count_(count), width_(width), data_(count * width, 0) {
+    assert(width > 0);
+}
+
+size_t big_integer_batch::size() const {
+    return count_;
+}
+
+size_t big_integer_batch::width() const {
+    return width_;
+}
+
+uint32_t const* big_integer_batch::row(size_t limb) const {
+    return data_.data() + limb * count_;
+}
+
+uint32_t* big_integer_batch::row(size_t limb) {
+    return data_.data() + limb * count_;
+}
+
+void big_integer_batch::set(size_t idx, big_integer const& value) {
+    for (size_t j = 0; j < width_; j++) {
+        data_[j * count_ + idx] = value.limb(j);
+    }
+}
+
+big_integer big_integer_batch::get(size_t idx) const {
+    std::vector<uint32_t> limbs(width_);
+    for (size_t j = 0; j < width_; j++) {
+        limbs[j] = data_[j * count_ + idx];
+    }
+    return big_integer::from_limbs(limbs.data(), width_, false);
+}
+
+void add(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b) {
+    assert(a.size() == b.size() && a.size() == dst.size());
+    assert(a.width() == b.width() && a.width() == dst.width());
+    auto d = rows(dst);
+    auto x = rows(a), y = rows(b);
+    size_t done = use_avx2() ? add_lanes_avx2(d.data(), x.data(), y.data(), a.width(), a.size()) : 0;
+    add_lanes(d.data(), x.data(), y.data(), a.width(), done, a.size());
+}
+
+void sub(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b) {
+    assert(a.size() == b.size() && a.size() == dst.size());
+    assert(a.width() == b.width() && a.width() == dst.width());
+    auto d = rows(dst);
+    auto x = rows(a), y = rows(b);
+    size_t done = use_avx2() ? sub_lanes_avx2(d.data(), x.data(), y.data(), a.width(), a.size()) : 0;
+    sub_lanes(d.data(), x.data(), y.data(), a.width(), done, a.size());
+}
+
+void mul(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b) {
+    assert(a.size() == b.size() && a.size() == dst.size());
+    assert(dst.width() == a.width() + b.width());
+    assert(&dst != &a && &dst != &b);
+    auto d = rows(dst);
+    auto x = rows(a), y = rows(b);
+    size_t done = use_avx2() ? mul_lanes_avx2(d.data(), x.data(), y.data(), a.width(), b.width(), a.size()) : 0;
+    mul_lanes(d.data(), x.data(), y.data(), a.width(), b.width(), done, a.size());
+}
+
+std::vector<int8_t> compare(big_integer_batch const& a, big_integer_batch const& b) {
+    assert(a.size() == b.size() && a.width() == b.width());
+    std::vector<int8_t> result(a.size());
+    auto x = rows(a), y = rows(b);
+    size_t done = use_avx2() ? compare_lanes_avx2(result.data(), x.data(), y.data(), a.width(), a.size()) : 0;
+    compare_lanes(result.data(), x.data(), y.data(), a.width(), done, a.size());
+    return result;
+}
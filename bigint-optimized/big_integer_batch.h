@@ -0,0 +1,38 @@
+#ifndef BIG_INTEGER_BATCH_H
+#define BIG_INTEGER_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <big_integer.h>
+
+// size() unsigned integers of width() limbs each, arithmetic is modulo 2 ^ {32 * width()}.
+// Structure of arrays: limb j of every integer is stored contiguously, so the kernels run
+// across integers in lockstep instead of along the limbs of one integer.
+struct big_integer_batch {
+    big_integer_batch(size_t count, size_t width);
+
+    size_t size() const;
+    size_t width() const;
+
+    void set(size_t idx, big_integer const& value);                 // takes value modulo 2 ^ {32 * width()}
+    big_integer get(size_t idx) const;
+
+    uint32_t const* row(size_t limb) const;                         // limb-th limb of every integer
+    uint32_t* row(size_t limb);
+
+ private:
+    size_t count_;
+    size_t width_;
+    std::vector<uint32_t> data_;
+};
+
+// a, b and dst share size() and width()
+void add(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b);
+void sub(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b);
+// dst.width() == a.width() + b.width(), so products are exact
+void mul(big_integer_batch& dst, big_integer_batch const& a, big_integer_batch const& b);
+// -1, 0 or 1 for every pair
+std::vector<int8_t> compare(big_integer_batch const& a, big_integer_batch const& b);
+
+#endif // BIG_INTEGER_BATCH_H
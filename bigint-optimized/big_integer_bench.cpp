@@ -0,0 +1,245 @@
+// Throughput of big_integer against big_integer_gmp (GMP) over operand sizes from 1 limb up.
+//
+// usage: big_integer_bench [--max-limbs N] [--min-time SECONDS] [--max-op-time SECONDS]
+//                          [--seed N] [--filter OP] [--json FILE] [--kernels LEVEL|all]
+//
+// --kernels runs big_integer alone, once per kernel level (baseline, asm_adc, bmi2_adx, avx2,
+// avx512), or at the one named level; "all" compares every level the host supports and the
+// build has compiled in side by side.
+// Only builds with kernel dispatch (BIGINT_KERNELS) accept it.
+//
+// bigint and bigint-optimized both compile this file; the headers are taken from the include
+// path, so each build measures its own big_integer.
+//
+// Sizes grow by a factor of 4. For every operation and implementation the sweep stops
+// once a single call takes longer than --max-op-time, so quadratic operations end early
+// instead of running for hours at 1M limbs.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <big_integer.h>
+#include <big_integer_gmp.h>
+#ifdef BIGINT_KERNELS
+#include <big_integer_kernels.h>
+#endif
+
+namespace {
+struct options {
+  size_t max_limbs = size_t(1) << 20u;
+  double min_time = 0.2;
+  double max_op_time = 1.0;
+  unsigned seed = 42;
+  std::string filter;
+  std::string json;
+  std::string kernels;
+};
+
+struct result {
+  std::string op;
+  std::string impl;
+  size_t limbs;
+  size_t iterations;
+  double ns_per_op;
+  double mb_per_s;
+};
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start) {
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+template<typename T>
+T from_word(uint32_t word) {
+  return (T(static_cast<int>(word >> 16u)) << 16) | T(static_cast<int>(word & 0xffffu));
+}
+
+// divide and conquer, so building a 1M-limb operand costs O(n log n) instead of O(n ^ 2)
+template<typename T>
+T random_value(std::mt19937& rng, size_t limbs) {
+  if (limbs == 1) {
+    return from_word<T>(static_cast<uint32_t>(rng()));
+  }
+  size_t low = limbs / 2;
+  T lo = random_value<T>(rng, low);
+  T hi = random_value<T>(rng, limbs - low);
+  return (hi << static_cast<int>(32 * low)) | lo;
+}
+
+template<typename T>
+T random_operand(std::mt19937& rng, size_t limbs) {
+  T top = T(1) << static_cast<int>(32 * limbs - 1);               // exactly `limbs` limbs
+  return random_value<T>(rng, limbs) | top;
+}
+
+volatile bool sink;
+
+template<typename T>
+std::vector<std::pair<std::string, std::function<void()>>> make_ops(T const& a, T const& b, T const& half,
+                                                                    std::string const& text, size_t limbs) {
+  int shift = static_cast<int>(32 * limbs / 2 + 7);
+  return {
+      {"add", [&a, &b] { T r = a + b; sink = (r == a); }},
+      {"sub", [&a, &b] { T r = a - b; sink = (r == a); }},
+      {"mul", [&a, &b] { T r = a * b; sink = (r == a); }},
+      {"div", [&a, &half] { T r = a / half; sink = (r == a); }},
+      {"mod", [&a, &half] { T r = a % half; sink = (r == a); }},
+      {"shl", [&a, shift] { T r = a << shift; sink = (r == a); }},
+      {"shr", [&a, shift] { T r = a >> shift; sink = (r == a); }},
+      {"and", [&a, &b] { T r = a & b; sink = (r == a); }},
+      {"or", [&a, &b] { T r = a | b; sink = (r == a); }},
+      {"xor", [&a, &b] { T r = a ^ b; sink = (r == a); }},
+      {"to_string", [&a] { sink = to_string(a).empty(); }},
+      {"parse", [&a, &text] { T r(text); sink = (r == a); }},
+  };
+}
+
+// time per call in ns and number of calls, after one warm-up call
+std::pair<double, size_t> measure(std::function<void()> const& op, options const& opt) {
+  clock_type::time_point start = clock_type::now();
+  op();
+  double warm_up = seconds_since(start);
+  if (warm_up > opt.max_op_time) {
+    return {warm_up * 1e9, 1};
+  }
+  size_t iterations = 0;
+  start = clock_type::now();
+  double elapsed;
+  do {
+    op();
+    iterations++;
+    elapsed = seconds_since(start);
+  } while (elapsed < opt.min_time);
+  return {elapsed * 1e9 / iterations, iterations};
+}
+
+template<typename T>
+void run_impl(std::string const& impl, options const& opt, std::vector<result>& results) {
+  std::mt19937 rng(opt.seed);
+  std::vector<std::string> stopped;
+  for (size_t limbs = 1; limbs <= opt.max_limbs; limbs *= 4) {
+    T a = random_operand<T>(rng, limbs);
+    T b = random_operand<T>(rng, limbs);
+    T half = random_operand<T>(rng, limbs / 2 + 1);
+    a = (a << static_cast<int>(32 * (limbs / 2))) + b;             // a has ~1.5x limbs, a / half is balanced
+    std::string text;
+    bool need_text = opt.filter.empty() || opt.filter == "parse";
+    bool text_stopped = false;
+    for (std::string const& op : stopped) {
+      text_stopped |= (op == "to_string");
+    }
+    if (need_text && !text_stopped) {
+      text = to_string(a);
+    }
+    for (auto const& op : make_ops(a, b, half, text, limbs)) {
+      if (!opt.filter.empty() && op.first != opt.filter) {
+        continue;
+      }
+      bool skip = false;
+      for (std::string const& name : stopped) {
+        skip |= (name == op.first);
+      }
+      if (skip || (op.first == "parse" && text.empty())) {
+        continue;
+      }
+      std::pair<double, size_t> time = measure(op.second, opt);
+      double bytes = 4.0 * limbs;
+      results.push_back({op.first, impl, limbs, time.second, time.first, bytes / time.first * 1e3});
+      result const& r = results.back();
+      std::cout << std::left << std::setw(10) << r.op << std::setw(10) << r.impl << std::right
+                << std::setw(9) << r.limbs << std::setw(16) << std::fixed << std::setprecision(1)
+                << r.ns_per_op << " ns/op" << std::setw(12) << std::setprecision(2) << r.mb_per_s << " MB/s"
+                << std::endl;
+      if (time.first * 1e-9 > opt.max_op_time) {
+        stopped.push_back(op.first);
+      }
+    }
+  }
+}
+
+void write_json(std::ostream& out, options const& opt, std::vector<result> const& results) {
+  out << "{\n  \"seed\": " << opt.seed << ",\n  \"min_time\": " << opt.min_time << ",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    result const& r = results[i];
+    out << "    {\"op\": \"" << r.op << "\", \"impl\": \"" << r.impl << "\", \"limbs\": " << r.limbs
+        << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << std::setprecision(6) << r.ns_per_op
+        << ", \"mb_per_s\": " << r.mb_per_s << "}" << (i + 1 == results.size() ? "\n" : ",\n");
+  }
+  out << "  ]\n}\n";
+}
+
+options parse_options(int argc, char** argv) {
+  options opt;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+    if (key == "--max-limbs") {
+      opt.max_limbs = std::strtoull(value.c_str(), nullptr, 10);
+    } else if (key == "--min-time") {
+      opt.min_time = std::atof(value.c_str());
+    } else if (key == "--max-op-time") {
+      opt.max_op_time = std::atof(value.c_str());
+    } else if (key == "--seed") {
+      opt.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    } else if (key == "--filter") {
+      opt.filter = value;
+    } else if (key == "--json") {
+      opt.json = value;
+    } else if (key == "--kernels") {
+      opt.kernels = value;
+    } else {
+      std::cerr << "unknown option " << key << std::endl;
+      std::exit(1);
+    }
+  }
+  return opt;
+}
+}
+
+int main(int argc, char** argv) {
+  options opt = parse_options(argc, argv);
+  std::vector<result> results;
+  if (opt.kernels.empty()) {
+    run_impl<big_integer>("big", opt, results);
+    run_impl<big_integer_gmp>("gmp", opt, results);
+  } else {
+#ifdef BIGINT_KERNELS
+    using big_integer_kernels::level;
+    bool found = false;
+    for (int l = 0; l <= static_cast<int>(big_integer_kernels::detected()); l++) {
+      char const* name = big_integer_kernels::name(static_cast<level>(l));
+      if (!big_integer_kernels::compiled(static_cast<level>(l))) {
+        continue;
+      }
+      if (opt.kernels == "all" || opt.kernels == name) {
+        big_integer_kernels::force(static_cast<level>(l));
+        run_impl<big_integer>(name, opt, results);
+        found = true;
+      }
+    }
+    if (!found) {
+      std::cerr << "kernel level " << opt.kernels << " is unknown or not supported, this CPU goes up to "
+                << big_integer_kernels::name(big_integer_kernels::detected()) << std::endl;
+      return 1;
+    }
+#else
+    std::cerr << "--kernels needs a build with kernel dispatch" << std::endl;
+    return 1;
+#endif
+  }
+  if (!opt.json.empty()) {
+    std::ofstream out(opt.json);
+    write_json(out, opt, results);
+  }
+  return 0;
+}
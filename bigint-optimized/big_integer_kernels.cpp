@@ -0,0 +1,533 @@
+#include "big_integer_kernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <immintrin.h>
+#include <utility>
+#ifdef BIGINT_ASM_KERNELS
+#include <long_arith.h>
+#endif
+
+namespace big_integer_kernels {
+namespace {
+    const size_t LEVELS = 5;
+
+    uint64_t load_pair(uint32_t const* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    void store_pair(uint32_t* p, uint64_t v) {
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    ////////////////////////////////////////////////////////////////////////// baseline
+
+    uint32_t add_n_baseline(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t cur = carry + a[i] + b[i];
+            r[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t sub_n_baseline(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32u) & 1u;
+        }
+        return static_cast<uint32_t>(borrow);
+    }
+
+    uint32_t mul_1_baseline(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b + carry;
+            r[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t addmul_1_baseline(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b + r[i] + carry; // at most 2 ^ 64 - 1
+            r[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t submul_1_baseline(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t product = static_cast<uint64_t>(a[i]) * b + carry;
+            uint32_t low = static_cast<uint32_t>(product);
+            carry = (product >> 32u) + (r[i] < low);
+            r[i] -= low;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t lshift_baseline(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[n - 1] >> (32 - bits);
+        for (size_t i = n - 1; i > 0; --i) {                        // top down, so r above a reads sources first
+            r[i] = (a[i] << bits) | (a[i - 1] >> (32 - bits));
+        }
+        r[0] = a[0] << bits;
+        return out;
+    }
+
+    uint32_t rshift_baseline(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[0] << (32 - bits);
+        for (size_t i = 0; i + 1 < n; i++) {                        // bottom up, for r below a
+            r[i] = (a[i] >> bits) | (a[i + 1] << (32 - bits));
+        }
+        r[n - 1] = a[n - 1] >> bits;
+        return out;
+    }
+
+    void and_n_baseline(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] & b[i];
+        }
+    }
+
+    void or_n_baseline(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] | b[i];
+        }
+    }
+
+    void xor_n_baseline(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] ^ b[i];
+        }
+    }
+
+#ifdef BIGINT_ASM_KERNELS
+    ////////////////////////////////////////////////////////////////////////// asm_adc
+
+    // The routines of asm/long_arith.asm work in place on qwords, so r starts as a copy of the
+    // first operand and an odd top limb is finished here. They use nothing past plain x86-64.
+
+    uint64_t* qwords(uint32_t* p) {
+        return reinterpret_cast<uint64_t*>(p);
+    }
+
+    uint64_t const* qwords(uint32_t const* p) {
+        return reinterpret_cast<uint64_t const*>(p);
+    }
+
+    uint32_t add_n_asm(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        if (r == b) {
+            std::swap(a, b);                                        // r = b + a
+        }
+        if (r != a) {
+            std::memcpy(r, a, n * sizeof(uint32_t));
+        }
+        uint64_t carry = add_long_long(qwords(r), qwords(b), n / 2);
+        if (n % 2 != 0) {
+            carry += static_cast<uint64_t>(r[n - 1]) + b[n - 1];
+            r[n - 1] = static_cast<uint32_t>(carry);
+            carry >>= 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    uint32_t sub_n_asm(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        if (r == b && r != a) {
+            return sub_n_baseline(r, a, b, n);                      // r = a - r has no in-place form
+        }
+        if (r != a) {
+            std::memcpy(r, a, n * sizeof(uint32_t));
+        }
+        uint64_t borrow = sub_long_long(qwords(r), qwords(b), n / 2);
+        if (n % 2 != 0) {
+            uint64_t cur = static_cast<uint64_t>(r[n - 1]) - b[n - 1] - borrow;
+            r[n - 1] = static_cast<uint32_t>(cur);
+            borrow = (cur >> 32u) & 1u;
+        }
+        return static_cast<uint32_t>(borrow);
+    }
+
+    uint32_t mul_1_asm(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        if (r != a) {
+            std::memcpy(r, a, n * sizeof(uint32_t));
+        }
+        uint64_t carry = mul_long_short(qwords(r), n / 2, b);      // below 2 ^ 32, as b is
+        if (n % 2 != 0) {
+            carry += static_cast<uint64_t>(r[n - 1]) * b;
+            r[n - 1] = static_cast<uint32_t>(carry);
+            carry >>= 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+#endif
+
+    ////////////////////////////////////////////////////////////////////////// bmi2_adx
+
+    // Pairs of limbs are one 64-bit limb on a little-endian machine, which halves the carry
+    // chain; an odd top limb is finished with 32-bit instructions.
+
+    __attribute__((target("adx")))
+    uint32_t add_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long sum;
+            carry = _addcarryx_u64(carry, load_pair(a + i), load_pair(b + i), &sum);
+            store_pair(r + i, sum);
+        }
+        if (i < n) {
+            unsigned int sum;
+            carry = _addcarryx_u32(carry, a[i], b[i], &sum);
+            r[i] = sum;
+        }
+        return carry;
+    }
+
+    __attribute__((target("adx")))
+    uint32_t sub_n_adx(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+        unsigned char borrow = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long diff;
+            borrow = _subborrow_u64(borrow, load_pair(a + i), load_pair(b + i), &diff);
+            store_pair(r + i, diff);
+        }
+        if (i < n) {
+            unsigned int diff;
+            borrow = _subborrow_u32(borrow, a[i], b[i], &diff);
+            r[i] = diff;
+        }
+        return borrow;
+    }
+
+    // a 64-bit limb times b < 2 ^ 32 has a high half below 2 ^ 32 - 1, so adding a carry below
+    // 2 ^ 32 and another 64-bit limb still leaves the next carry below 2 ^ 32
+
+    __attribute__((target("bmi2,adx")))
+    uint32_t mul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        unsigned long long carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long high, low = _mulx_u64(load_pair(a + i), b, &high);
+            high += _addcarryx_u64(0, low, carry, &low);
+            store_pair(r + i, low);
+            carry = high;
+        }
+        if (i < n) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b + carry;
+            r[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    // two carry chains, one adding the high half of the previous product and one adding r, which
+    // adcx and adox keep in separate flags; both carries land in the limb above, folded in at the end
+    __attribute__((target("bmi2,adx")))
+    uint32_t addmul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        unsigned long long previous = 0;
+        unsigned char c1 = 0, c2 = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {                                // two 64-bit limbs per round
+            unsigned long long high0, low0 = _mulx_u64(load_pair(a + i), b, &high0), sum0;
+            unsigned long long high1, low1 = _mulx_u64(load_pair(a + i + 2), b, &high1), sum1;
+            c1 = _addcarryx_u64(c1, low0, previous, &low0);
+            c1 = _addcarryx_u64(c1, low1, high0, &low1);
+            c2 = _addcarryx_u64(c2, low0, load_pair(r + i), &sum0);
+            c2 = _addcarryx_u64(c2, low1, load_pair(r + i + 2), &sum1);
+            store_pair(r + i, sum0);
+            store_pair(r + i + 2, sum1);
+            previous = high1;
+        }
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long high, low = _mulx_u64(load_pair(a + i), b, &high), sum;
+            c1 = _addcarryx_u64(c1, low, previous, &low);
+            c2 = _addcarryx_u64(c2, low, load_pair(r + i), &sum);
+            store_pair(r + i, sum);
+            previous = high;
+        }
+        unsigned long long carry = previous + c1 + c2;
+        if (i < n) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b + r[i] + carry;
+            r[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    __attribute__((target("bmi2,adx")))
+    uint32_t submul_1_bmi2(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+        unsigned long long carry = 0;
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            unsigned long long high, low = _mulx_u64(load_pair(a + i), b, &high), diff;
+            high += _addcarryx_u64(0, low, carry, &low);
+            high += _subborrow_u64(0, load_pair(r + i), low, &diff);
+            store_pair(r + i, diff);
+            carry = high;
+        }
+        if (i < n) {
+            uint64_t product = static_cast<uint64_t>(a[i]) * b + carry;
+            uint32_t low = static_cast<uint32_t>(product);
+            carry = (product >> 32u) + (r[i] < low);
+            r[i] -= low;
+        }
+        return static_cast<uint32_t>(carry);
+    }
+
+    ////////////////////////////////////////////////////////////////////////// avx2
+
+    // r[i] = a[i] << bits | a[i - 1] >> (32 - bits) for eight limbs at a time, from the top down;
+    // both loads of a block come before its store, so r above a never reads a shifted limb
+    __attribute__((target("avx2")))
+    uint32_t lshift_avx2(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[n - 1] >> (32 - bits);
+        __m128i count = _mm_cvtsi32_si128(static_cast<int>(bits));
+        __m128i rest = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+        size_t i = n;
+        for (; i >= 9; i -= 8) {
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i - 8));
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i - 9));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i - 8),
+                                _mm256_or_si256(_mm256_sll_epi32(hi, count), _mm256_srl_epi32(lo, rest)));
+        }
+        lshift_baseline(r, a, i, bits);
+        return out;
+    }
+
+    __attribute__((target("avx2")))
+    uint32_t rshift_avx2(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[0] << (32 - bits);
+        __m128i count = _mm_cvtsi32_si128(static_cast<int>(bits));
+        __m128i rest = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+        size_t i = 0;
+        for (; i + 9 <= n; i += 8) {
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i + 1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i),
+                                _mm256_or_si256(_mm256_srl_epi32(lo, count), _mm256_sll_epi32(hi, rest)));
+        }
+        rshift_baseline(r + i, a + i, n - i, bits);
+        return out;
+    }
+
+#define BIGINT_BITWISE_AVX2(op, intrinsic)                                                          \
+    __attribute__((target("avx2")))                                                                \
+    void op##_n_avx2(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {                 \
+        size_t i = 0;                                                                               \
+        for (; i + 8 <= n; i += 8) {                                                                \
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));                \
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));                \
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), intrinsic(x, y));                \
+        }                                                                                           \
+        op##_n_baseline(r + i, a + i, b + i, n - i);                                                \
+    }
+
+    BIGINT_BITWISE_AVX2(and, _mm256_and_si256)
+    BIGINT_BITWISE_AVX2(or, _mm256_or_si256)
+    BIGINT_BITWISE_AVX2(xor, _mm256_xor_si256)
+#undef BIGINT_BITWISE_AVX2
+
+    ////////////////////////////////////////////////////////////////////////// avx512
+
+    // masked shifts with every lane set: the unmasked ones pass an undefined vector through,
+    // which trips -Wmaybe-uninitialized in GCC's headers
+    const __mmask16 ALL_LANES = 0xffff;
+
+    __attribute__((target("avx512f")))
+    uint32_t lshift_avx512(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[n - 1] >> (32 - bits);
+        __m128i count = _mm_cvtsi32_si128(static_cast<int>(bits));
+        __m128i rest = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+        size_t i = n;
+        for (; i >= 17; i -= 16) {
+            __m512i hi = _mm512_loadu_si512(a + i - 16);
+            __m512i lo = _mm512_loadu_si512(a + i - 17);
+            _mm512_storeu_si512(r + i - 16, _mm512_or_si512(_mm512_maskz_sll_epi32(ALL_LANES, hi, count),
+                                                             _mm512_maskz_srl_epi32(ALL_LANES, lo, rest)));
+        }
+        lshift_baseline(r, a, i, bits);
+        return out;
+    }
+
+    __attribute__((target("avx512f")))
+    uint32_t rshift_avx512(uint32_t* r, uint32_t const* a, size_t n, unsigned bits) {
+        uint32_t out = a[0] << (32 - bits);
+        __m128i count = _mm_cvtsi32_si128(static_cast<int>(bits));
+        __m128i rest = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+        size_t i = 0;
+        for (; i + 17 <= n; i += 16) {
+            __m512i lo = _mm512_loadu_si512(a + i);
+            __m512i hi = _mm512_loadu_si512(a + i + 1);
+            _mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_maskz_srl_epi32(ALL_LANES, lo, count),
+                                                       _mm512_maskz_sll_epi32(ALL_LANES, hi, rest)));
+        }
+        rshift_baseline(r + i, a + i, n - i, bits);
+        return out;
+    }
+
+    // the tail below 16 limbs goes through masked loads and stores, which do not touch masked-off limbs
+#define BIGINT_BITWISE_AVX512(op, intrinsic)                                                        \
+    __attribute__((target("avx512f")))                                                             \
+    void op##_n_avx512(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {               \
+        size_t i = 0;                                                                               \
+        for (; i + 16 <= n; i += 16) {                                                              \
+            _mm512_storeu_si512(r + i, intrinsic(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))); \
+        }                                                                                           \
+        if (i < n) {                                                                                \
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);                            \
+            __m512i x = _mm512_maskz_loadu_epi32(mask, a + i);                                      \
+            __m512i y = _mm512_maskz_loadu_epi32(mask, b + i);                                      \
+            _mm512_mask_storeu_epi32(r + i, mask, intrinsic(x, y));                                 \
+        }                                                                                           \
+    }
+
+    BIGINT_BITWISE_AVX512(and, _mm512_and_si512)
+    BIGINT_BITWISE_AVX512(or, _mm512_or_si512)
+    BIGINT_BITWISE_AVX512(xor, _mm512_xor_si512)
+#undef BIGINT_BITWISE_AVX512
+
+    ////////////////////////////////////////////////////////////////////////// binding
+
+    bool supports(level l) {
+        switch (l) {
+            case level::baseline:
+            case level::asm_adc:                                    // plain x86-64, but see compiled()
+                return true;
+            case level::bmi2_adx:
+                return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+            case level::avx2:
+                return __builtin_cpu_supports("avx2");
+            case level::avx512:
+                return __builtin_cpu_supports("avx512f");
+        }
+        return false;
+    }
+
+    // Carries do not vectorize, so add, sub and the multiplications stop at bmi2_adx and the
+    // vector levels only replace the shifts and bitwise operations. The arithmetic and vector
+    // kernels are picked independently: a CPU with AVX2 but no ADX gets both it can run, and
+    // the asm routines, when compiled in, stand in for the ADX ones.
+    table bind(level cap) {
+        table t = {add_n_baseline, sub_n_baseline, mul_1_baseline, addmul_1_baseline, submul_1_baseline,
+                   lshift_baseline, rshift_baseline, and_n_baseline, or_n_baseline, xor_n_baseline};
+#ifdef BIGINT_ASM_KERNELS
+        if (cap >= level::asm_adc) {
+            t.add_n = add_n_asm;
+            t.sub_n = sub_n_asm;
+            t.mul_1 = mul_1_asm;
+        }
+#endif
+        if (cap >= level::bmi2_adx && supports(level::bmi2_adx)) {
+            t.add_n = add_n_adx;
+            t.sub_n = sub_n_adx;
+            t.mul_1 = mul_1_bmi2;
+            t.addmul_1 = addmul_1_bmi2;
+            t.submul_1 = submul_1_bmi2;
+        }
+        if (cap >= level::avx2 && supports(level::avx2)) {
+            t.lshift = lshift_avx2;
+            t.rshift = rshift_avx2;
+            t.and_n = and_n_avx2;
+            t.or_n = or_n_avx2;
+            t.xor_n = xor_n_avx2;
+        }
+        if (cap >= level::avx512 && supports(level::avx512)) {
+            t.lshift = lshift_avx512;
+            t.rshift = rshift_avx512;
+            t.and_n = and_n_avx512;
+            t.or_n = or_n_avx512;
+            t.xor_n = xor_n_avx512;
+        }
+        return t;
+    }
+
+    struct bindings {
+        level host = level::baseline;
+        bool supported[LEVELS];
+        table tables[LEVELS];
+        std::atomic<level> active;
+
+        bindings() {
+            __builtin_cpu_init();
+            for (size_t i = 0; i < LEVELS; i++) {
+                tables[i] = bind(static_cast<level>(i));
+                supported[i] = supports(static_cast<level>(i));
+                if (supported[i]) {
+                    host = static_cast<level>(i);
+                }
+            }
+            active.store(host, std::memory_order_relaxed);
+        }
+    };
+
+    bindings& state() {
+        static bindings instance;
+        return instance;
+    }
+}
+
+table const& kernels() {
+    bindings& s = state();
+    return s.tables[static_cast<size_t>(s.active.load(std::memory_order_relaxed))];
+}
+
+level detected() {
+    return state().host;
+}
+
+level active() {
+    return state().active.load(std::memory_order_relaxed);
+}
+
+bool allows(level l) {
+    bindings& s = state();
+    return l <= s.active.load(std::memory_order_relaxed) && s.supported[static_cast<size_t>(l)] && compiled(l);
+}
+
+bool compiled(level l) {
+#ifdef BIGINT_ASM_KERNELS
+    return true;
+#else
+    return l != level::asm_adc;
+#endif
+}
+
+void force(level cap) {
+    if (cap > detected()) {
+        throw std::invalid_argument(std::string("Kernel level not supported by this CPU: ") + name(cap));
+    }
+    if (!compiled(cap)) {
+        throw std::invalid_argument(std::string("Kernel level not compiled in: ") + name(cap));
+    }
+    state().active.store(cap, std::memory_order_relaxed);
+}
+
+char const* name(level l) {
+    switch (l) {
+        case level::baseline:
+            return "baseline";
+        case level::asm_adc:
+            return "asm_adc";
+        case level::bmi2_adx:
+            return "bmi2_adx";
+        case level::avx2:
+            return "avx2";
+        case level::avx512:
+            return "avx512";
+    }
+    return "unknown";
+}
+}
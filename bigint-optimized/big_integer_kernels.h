@@ -0,0 +1,49 @@
+#ifndef BIG_INTEGER_KERNELS_H
+#define BIG_INTEGER_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Limb loops behind big_integer arithmetic, bound once per process to the best implementation
+// the CPU supports, so one binary runs on every generation of x86-64 it is deployed to. The
+// levels are cumulative caps: a level allows its own instructions and everything below it, and
+// every kernel takes the best implementation within the cap that the host can run.
+//
+// Operands are n >= 1 limbs, least significant first. r may equal a or b; the shifts also allow
+// r above a (lshift) or below a (rshift), as an in-place shift by whole limbs needs.
+namespace big_integer_kernels {
+    enum class level {
+        baseline,                                                   // portable C++, 32-bit limb at a time
+        asm_adc,                                                    // add, sub and mul_1 from asm/long_arith.asm
+        bmi2_adx,                                                   // mulx and add-with-carry over 64-bit limb pairs
+        avx2,                                                       // + 256-bit shifts and bitwise operations
+        avx512                                                      // + 512-bit shifts and bitwise operations
+    };
+
+    struct table {
+        uint32_t (*add_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);        // returns the carry
+        uint32_t (*sub_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);        // returns the borrow
+        uint32_t (*mul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);               // r = a * b
+        uint32_t (*addmul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);            // r += a * b
+        uint32_t (*submul_1)(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);            // r -= a * b
+        uint32_t (*lshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned bits);           // 0 < bits < 32
+        uint32_t (*rshift)(uint32_t* r, uint32_t const* a, size_t n, unsigned bits);           // 0 < bits < 32
+        void (*and_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+        void (*or_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+        void (*xor_n)(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+    };
+    // the multiplications return the limb carried (borrowed) out of r[n - 1], lshift the bits
+    // shifted out of the top as the low bits of a limb, rshift those out of the bottom as its high bits
+
+    table const& kernels();                                         // the bound kernels, probing the CPU on first use
+
+    level detected();                                               // the highest level the host supports
+    level active();
+    bool allows(level l);                                           // l <= active() and the host runs l's instructions
+    bool compiled(level l);                                         // false for asm_adc without BIGINT_ASM_KERNELS
+    void force(level cap);                                          // rebinds; throws std::invalid_argument above detected()
+                                                                    // or for a level that is not compiled
+    char const* name(level l);                                      // "baseline", "asm_adc", "bmi2_adx", "avx2", "avx512"
+}
+
+#endif // BIG_INTEGER_KERNELS_H
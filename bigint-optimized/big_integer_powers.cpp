@@ -0,0 +1,101 @@
+#include "big_integer_powers.h"
+
+#include <mutex>
+#include <vector>
+
+namespace big_integer_powers {
+namespace {
+    const uint32_t BASE = 1000 * 1000 * 1000;
+    const size_t BASE_DIGITS = 9;
+    const size_t SMALL_POWERS = 64;                                 // 10 ^ 0 .. 10 ^ 63, fixed on first use
+
+    std::mutex mutex_;
+    std::vector<big_integer> powers_;                               // powers_[k] = 10 ^ {9 * 2 ^ k}, a prefix
+    size_t cached_limbs_ = 0;
+    size_t memory_limit_ = DEFAULT_MEMORY_LIMIT;
+
+    std::vector<big_integer> const& small_powers() {
+        static std::vector<big_integer> const table = [] {
+            std::vector<big_integer> powers(SMALL_POWERS);
+            powers[0] = 1;
+            for (size_t i = 1; i < SMALL_POWERS; i++) {
+                powers[i] = powers[i - 1] * 10;
+            }
+            return powers;
+        }();
+        return table;
+    }
+}
+
+// squares outside the lock, so readers of cached powers never wait on a multiplication; a power
+// is published only as the next entry of the prefix, threads racing for it compute it twice
+big_integer decimal_base(size_t k) {
+    big_integer power;
+    size_t i;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (k < powers_.size()) {
+            return powers_[k];
+        }
+        i = powers_.size();
+        power = powers_.empty() ? big_integer(BASE) : powers_.back();
+    }
+    for (; ; i++) {
+        if (i != 0) {
+            power *= power;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (k < powers_.size()) {                               // published meanwhile
+                return powers_[k];
+            }
+            if (i == powers_.size() && cached_limbs_ + power.limb_count() <= memory_limit_) {
+                powers_.push_back(power);
+                cached_limbs_ += power.limb_count();
+            }
+        }
+        if (i == k) {
+            return power;
+        }
+    }
+}
+
+// 10 ^ {9 q + r} = 10 ^ r * product of 10 ^ {9 * 2 ^ k} over the bits k of q
+big_integer ten(size_t exponent) {
+    std::vector<big_integer> const& small = small_powers();
+    if (exponent < SMALL_POWERS) {
+        return small[exponent];
+    }
+    big_integer result = small[exponent % BASE_DIGITS];
+    size_t q = exponent / BASE_DIGITS;
+    for (size_t k = 0; q != 0; k++, q >>= 1u) {
+        if (q & 1u) {
+            result *= decimal_base(k);
+        }
+    }
+    return result;
+}
+
+void warm_up(size_t digits) {
+    size_t chunks = (digits + BASE_DIGITS - 1) / BASE_DIGITS, k = 0;
+    while ((size_t(1) << (k + 1)) < chunks) {                       // a split of chunks takes 10 ^ {9 * 2 ^ k} at most
+        k++;
+    }
+    decimal_base(k);
+    small_powers();
+}
+
+void set_memory_limit(size_t limbs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_limit_ = limbs;
+    while (!powers_.empty() && cached_limbs_ > memory_limit_) {
+        cached_limbs_ -= powers_.back().limb_count();
+        powers_.pop_back();
+    }
+}
+
+size_t cached_limbs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_limbs_;
+}
+}
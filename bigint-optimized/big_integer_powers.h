@@ -0,0 +1,24 @@
+#ifndef BIG_INTEGER_POWERS_H
+#define BIG_INTEGER_POWERS_H
+
+#include <cstddef>
+#include <big_integer.h>
+
+// Process-wide cache of 10 ^ {9 * 2 ^ k}, the powers of the decimal conversion base that
+// parsing, printing, big_decimal and big_float split and scale by. It grows by squaring on
+// first use; the squaring runs outside the lock, which only guards lookups and publishing.
+// Cached powers are never modified, so the copies handed out share their limbs with the
+// cache and with each other. Powers that would push the cache past its memory limit are
+// computed for the caller and not kept.
+namespace big_integer_powers {
+    const size_t DEFAULT_MEMORY_LIMIT = size_t(1) << 24;           // limbs, 64 MiB
+
+    big_integer decimal_base(size_t k);                             // 10 ^ {9 * 2 ^ k}
+    big_integer ten(size_t exponent);                               // 10 ^ exponent, from the cached powers
+
+    void warm_up(size_t digits);                                    // caches what converting that many digits needs
+    void set_memory_limit(size_t limbs);                            // drops cached powers past the new limit
+    size_t cached_limbs();
+}
+
+#endif // BIG_INTEGER_POWERS_H
@@ -0,0 +1,94 @@
+#ifndef BIG_INTEGER_RANDOM_H
+#define BIG_INTEGER_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <big_integer.h>
+
+// Random values built limb by limb from a uniform random bit generator (std::mt19937,
+// std::mt19937_64, ...), without string round trips or repeated multiplication.
+namespace big_integer_random_detail {
+    // 32 random bits per call: one draw of a 32-bit engine, half a draw of a 64-bit one
+    template<typename RNG>
+    struct limb_source {
+        explicit limb_source(RNG& rng) : rng_(rng) {}
+
+        uint32_t next() {
+            constexpr uint64_t range = static_cast<uint64_t>(RNG::max() - RNG::min());
+            if constexpr (range == UINT64_MAX) {
+                if (has_spare_) {
+                    has_spare_ = false;
+                    return spare_;
+                }
+                uint64_t word = static_cast<uint64_t>(rng_() - RNG::min());
+                spare_ = static_cast<uint32_t>(word >> 32u);
+                has_spare_ = true;
+                return static_cast<uint32_t>(word);
+            } else if constexpr (range == UINT32_MAX) {
+                return static_cast<uint32_t>(rng_() - RNG::min());
+            } else {
+                return std::uniform_int_distribution<uint32_t>()(rng_);
+            }
+        }
+
+     private:
+        RNG& rng_;
+        uint32_t spare_ = 0;
+        bool has_spare_ = false;
+    };
+}
+
+// uniform in [0, 2 ^ bits)
+template<typename RNG>
+big_integer random_bits(size_t bits, RNG& rng) {
+    big_integer_random_detail::limb_source<RNG> source(rng);
+    size_t n = (bits + 31) / 32;
+    std::vector<uint32_t> limbs(n);
+    for (size_t i = 0; i < n; i++) {
+        limbs[i] = source.next();
+    }
+    if (bits % 32 != 0) {
+        limbs[n - 1] &= (1u << (bits % 32)) - 1;
+    }
+    return big_integer::from_limbs(limbs.data(), n, false);
+}
+
+// uniform in [0, bound), bound > 0. Candidates of bound's bit length are drawn from the most
+// significant limb down and rejected as soon as a limb decides they are not below bound, so
+// a rejection usually costs a single limb.
+template<typename RNG>
+big_integer random_below(big_integer const& bound, RNG& rng) {
+    if (bound <= 0) {
+        throw std::invalid_argument("random_below: bound must be positive");
+    }
+    big_integer_random_detail::limb_source<RNG> source(rng);
+    size_t n = bound.limb_count();
+    uint32_t top = bound.limb(n - 1);
+    uint32_t top_mask = top == 0 ? 0 : UINT32_MAX >> __builtin_clz(top);
+    std::vector<uint32_t> limbs(n);
+    for (;;) {
+        size_t i = n;
+        bool below = false;
+        for (; i > 0; --i) {
+            uint32_t word = source.next() & (i == n ? top_mask : UINT32_MAX);
+            uint32_t limit = bound.limb(i - 1);
+            limbs[i - 1] = word;
+            if (word != limit) {
+                below = (word < limit);
+                break;
+            }
+        }
+        if (!below) {
+            continue;
+        }
+        for (; i > 1; --i) {
+            limbs[i - 2] = source.next();
+        }
+        return big_integer::from_limbs(limbs.data(), n, false);
+    }
+}
+
+#endif // BIG_INTEGER_RANDOM_H
@@ -0,0 +1,121 @@
+#include "big_integer_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace big_integer_stats {
+namespace {
+    struct atomic_op_stats {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> nanoseconds;
+        std::atomic<uint64_t> size_histogram[SIZE_BUCKETS];
+    };
+
+    atomic_op_stats ops_[OPS];
+    std::atomic<uint64_t> allocations_;
+    std::atomic<uint64_t> unshares_;
+
+    char const* const NAMES[OPS] = {
+        "add", "sub", "mul", "div", "mod", "and", "or", "xor", "shl", "shr", "to_string", "parse"
+    };
+
+    size_t bucket(size_t limbs) {
+        return limbs <= 1 ? 0 : 63 - __builtin_clzll(limbs);
+    }
+
+    void dump_at_exit() {
+        char const* path = std::getenv("BIGINT_STATS_DUMP");
+        if (path[0] == '-' && path[1] == 0) {
+            dump(std::cerr);
+        } else {
+            std::ofstream out(path);
+            dump(out);
+        }
+    }
+
+    const bool DUMP_REGISTERED = enabled() && std::getenv("BIGINT_STATS_DUMP") != nullptr
+                                 && std::atexit(dump_at_exit) == 0;
+}
+
+bool enabled() {
+#ifdef BIGINT_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+char const* name(op_kind op) {
+    return NAMES[static_cast<size_t>(op)];
+}
+
+void record(op_kind op, size_t limbs, uint64_t nanoseconds) {
+    atomic_op_stats& stats = ops_[static_cast<size_t>(op)];
+    stats.calls.fetch_add(1, std::memory_order_relaxed);
+    stats.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    stats.size_histogram[bucket(limbs)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void count_allocation() {
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void count_unshare() {
+    unshares_.fetch_add(1, std::memory_order_relaxed);
+}
+
+snapshot get() {
+    snapshot result = {};
+    for (size_t i = 0; i < OPS; i++) {
+        result.ops[i].calls = ops_[i].calls.load(std::memory_order_relaxed);
+        result.ops[i].nanoseconds = ops_[i].nanoseconds.load(std::memory_order_relaxed);
+        for (size_t k = 0; k < SIZE_BUCKETS; k++) {
+            result.ops[i].size_histogram[k] = ops_[i].size_histogram[k].load(std::memory_order_relaxed);
+        }
+    }
+    result.allocations = allocations_.load(std::memory_order_relaxed);
+    result.unshares = unshares_.load(std::memory_order_relaxed);
+    return result;
+}
+
+void reset() {
+    for (size_t i = 0; i < OPS; i++) {
+        ops_[i].calls.store(0, std::memory_order_relaxed);
+        ops_[i].nanoseconds.store(0, std::memory_order_relaxed);
+        for (size_t k = 0; k < SIZE_BUCKETS; k++) {
+            ops_[i].size_histogram[k].store(0, std::memory_order_relaxed);
+        }
+    }
+    allocations_.store(0, std::memory_order_relaxed);
+    unshares_.store(0, std::memory_order_relaxed);
+}
+
+void dump(std::ostream& out) {
+    snapshot stats = get();
+    out << "big_integer stats" << (enabled() ? "" : " (instrumentation disabled)") << "\n";
+    for (size_t i = 0; i < OPS; i++) {
+        op_stats const& op = stats.ops[i];
+        if (op.calls == 0) {
+            continue;
+        }
+        out << "  " << NAMES[i] << ": calls " << op.calls << ", total " << op.nanoseconds << " ns, limbs log2";
+        for (size_t k = 0; k < SIZE_BUCKETS; k++) {
+            if (op.size_histogram[k] != 0) {
+                out << " [" << k << "]=" << op.size_histogram[k];
+            }
+        }
+        out << "\n";
+    }
+    out << "  allocations: " << stats.allocations << "\n";
+    out << "  unshares: " << stats.unshares << "\n";
+}
+
+scope::scope(op_kind op, size_t limbs) : op_(op), limbs_(limbs), start_(std::chrono::steady_clock::now()) {}
+
+scope::~scope() {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    record(op_, limbs_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+}
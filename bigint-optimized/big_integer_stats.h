@@ -0,0 +1,71 @@
+#ifndef BIG_INTEGER_STATS_H
+#define BIG_INTEGER_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Hot-path counters of big_integer, compiled in only with -DBIGINT_INSTRUMENTATION
+// (cmake -DBIGINT_INSTRUMENTATION=ON). Without it the hooks expand to nothing and
+// snapshot() stays all zero. Setting BIGINT_STATS_DUMP=<file> (or "-" for stderr)
+// dumps the counters at exit.
+namespace big_integer_stats {
+    enum class op_kind {
+        add, sub, mul, div, mod, bit_and, bit_or, bit_xor, shl, shr, to_string, parse, count
+    };
+
+    const size_t OPS = static_cast<size_t>(op_kind::count);
+    const size_t SIZE_BUCKETS = 64;                                 // bucket k -- operands of [2 ^ k, 2 ^ {k + 1}) limbs
+
+    struct op_stats {
+        uint64_t calls;
+        uint64_t nanoseconds;                                       // includes operators called from inside
+        uint64_t size_histogram[SIZE_BUCKETS];
+    };
+
+    struct snapshot {
+        op_stats ops[OPS];
+        uint64_t allocations;                                       // limb buffers: new vector blocks and block regrowth
+        uint64_t unshares;                                          // deep copies in shared_ptr_vector::get_unique
+    };
+
+    bool enabled();
+    snapshot get();
+    void reset();
+    void dump(std::ostream& out);
+    char const* name(op_kind op);
+
+    void record(op_kind op, size_t limbs, uint64_t nanoseconds);
+    void count_allocation();
+    void count_unshare();
+
+    struct scope {
+        scope(op_kind op, size_t limbs);
+        ~scope();
+
+     private:
+        op_kind op_;
+        size_t limbs_;
+        std::chrono::steady_clock::time_point start_;
+    };
+}
+
+#ifdef BIGINT_INSTRUMENTATION
+#define BIGINT_STATS_CONCAT_(a, b) a##b
+#define BIGINT_STATS_CONCAT(a, b) BIGINT_STATS_CONCAT_(a, b)
+#define BIGINT_STATS_OP(op, limbs) \
+    big_integer_stats::scope BIGINT_STATS_CONCAT(stats_scope_, __LINE__)(big_integer_stats::op_kind::op, (limbs))
+#define BIGINT_STATS_OP_ADD_SUB(subtract, limbs) \
+    big_integer_stats::scope BIGINT_STATS_CONCAT(stats_scope_, __LINE__)( \
+        (subtract) ? big_integer_stats::op_kind::sub : big_integer_stats::op_kind::add, (limbs))
+#define BIGINT_STATS_ALLOCATION() big_integer_stats::count_allocation()
+#define BIGINT_STATS_UNSHARE() big_integer_stats::count_unshare()
+#else
+#define BIGINT_STATS_OP(op, limbs) ((void) 0)
+#define BIGINT_STATS_OP_ADD_SUB(subtract, limbs) ((void) 0)
+#define BIGINT_STATS_ALLOCATION() ((void) 0)
+#define BIGINT_STATS_UNSHARE() ((void) 0)
+#endif
+
+#endif // BIG_INTEGER_STATS_H
@@ -0,0 +1,208 @@
+#include "big_rational.h"
+
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    const size_t NORMALIZE_SLACK = 8;                               // limbs an unreduced fraction may gain for free
+}
+
+big_rational::big_rational() : big_rational(0) {}
+
+big_rational::big_rational(int a) : big_rational(big_integer(a)) {}
+
+big_rational::big_rational(big_integer const& a)
+    : num_(a), den_(1), normalized_(true), normalized_limbs_(limbs()) {}
+
+big_rational::big_rational(big_integer const& num, big_integer const& den)
+    : num_(num), den_(den), normalized_(den == 1), normalized_limbs_(0) {
+    if (den_ == 0) {
+        throw std::overflow_error("Divide by zero exception");
+    }
+    if (den_ < 0) {
+        num_ = -num_;
+        den_ = -den_;
+    }
+    normalized_limbs_ = limbs();
+}
+
+big_rational::big_rational(std::string const& str) : big_rational() {
+    size_t slash = str.find('/');
+    if (slash == std::string::npos) {
+        *this = big_rational(big_integer(str));
+    } else {
+        *this = big_rational(big_integer(str.substr(0, slash)), big_integer(str.substr(slash + 1)));
+    }
+}
+
+size_t big_rational::limbs() const {
+    return num_.limb_count() + den_.limb_count();
+}
+
+void big_rational::normalize() const {
+    if (normalized_) {
+        return;
+    }
+    big_integer g = gcd(num_, den_);
+    if (g != 1) {
+        num_ /= g;
+        den_ /= g;
+    }
+    normalized_ = true;
+    normalized_limbs_ = limbs();
+}
+
+void big_rational::maybe_normalize() {
+    if (!normalized_ && limbs() > 2 * normalized_limbs_ + NORMALIZE_SLACK) {
+        normalize();
+    }
+}
+
+big_integer const& big_rational::numerator() const {
+    normalize();
+    return num_;
+}
+
+big_integer const& big_rational::denominator() const {
+    normalize();
+    return den_;
+}
+
+big_rational& big_rational::operator+=(big_rational const& rhs) {
+    if (den_ == rhs.den_) {
+        num_ += rhs.num_;
+    } else {
+        num_ = num_ * rhs.den_ + rhs.num_ * den_;
+        den_ *= rhs.den_;
+    }
+    normalized_ = false;
+    maybe_normalize();
+    return *this;
+}
+
+big_rational& big_rational::operator-=(big_rational const& rhs) {
+    if (den_ == rhs.den_) {
+        num_ -= rhs.num_;
+    } else {
+        num_ = num_ * rhs.den_ - rhs.num_ * den_;
+        den_ *= rhs.den_;
+    }
+    normalized_ = false;
+    maybe_normalize();
+    return *this;
+}
+
+// (a / b) * (c / d) = ((a / gcd(a, d)) * (c / gcd(c, b))) / ((b / gcd(c, b)) * (d / gcd(a, d))):
+// two gcds of the operands instead of one of the products, and reduced inputs give a reduced result
+big_rational& big_rational::operator*=(big_rational const& rhs) {
+    big_integer g1 = gcd(num_, rhs.den_);
+    big_integer g2 = gcd(rhs.num_, den_);
+    big_integer num = (num_ / g1) * (rhs.num_ / g2);
+    big_integer den = (den_ / g2) * (rhs.den_ / g1);
+    normalized_ = normalized_ && rhs.normalized_;
+    num_ = std::move(num);
+    den_ = std::move(den);
+    maybe_normalize();
+    return *this;
+}
+
+big_rational& big_rational::operator/=(big_rational const& rhs) {
+    big_rational inverse(rhs.den_, rhs.num_);
+    inverse.normalized_ = rhs.normalized_;
+    return *this *= inverse;
+}
+
+big_rational big_rational::operator+() const {
+    return *this;
+}
+
+big_rational big_rational::operator-() const {
+    big_rational result(*this);
+    result.num_ = -result.num_;
+    return result;
+}
+
+big_rational operator+(big_rational a, big_rational const& b) {
+    return a += b;
+}
+
+big_rational operator-(big_rational a, big_rational const& b) {
+    return a -= b;
+}
+
+big_rational operator*(big_rational a, big_rational const& b) {
+    return a *= b;
+}
+
+big_rational operator/(big_rational a, big_rational const& b) {
+    return a /= b;
+}
+
+bool operator==(big_rational const& a, big_rational const& b) {
+    if (a.normalized_ && b.normalized_) {
+        return a.num_ == b.num_ && a.den_ == b.den_;
+    }
+    return a.num_ * b.den_ == b.num_ * a.den_;
+}
+
+bool operator!=(big_rational const& a, big_rational const& b) {
+    return !(a == b);
+}
+
+bool operator<(big_rational const& a, big_rational const& b) {
+    if (a.den_ == b.den_) {
+        return a.num_ < b.num_;
+    }
+    return a.num_ * b.den_ < b.num_ * a.den_;                       // denominators are positive
+}
+
+bool operator>(big_rational const& a, big_rational const& b) {
+    return b < a;
+}
+
+bool operator<=(big_rational const& a, big_rational const& b) {
+    return !(b < a);
+}
+
+bool operator>=(big_rational const& a, big_rational const& b) {
+    return !(a < b);
+}
+
+big_rational sum(big_rational const* terms, size_t count) {
+    if (count == 0) {
+        return big_rational();
+    }
+    big_integer num = terms[0].num_, den = terms[0].den_;
+    for (size_t i = 1; i < count; i++) {
+        big_rational const& term = terms[i];
+        if (term.den_ == den) {
+            num += term.num_;
+            continue;
+        }
+        big_integer g = gcd(den, term.den_);
+        big_integer scale = term.den_ / g;                          // den * scale is the lcm
+        num *= scale;
+        num += term.num_ * (den / g);
+        den *= scale;
+    }
+    big_rational result(num, den);
+    result.normalize();
+    return result;
+}
+
+big_rational sum(std::vector<big_rational> const& terms) {
+    return sum(terms.data(), terms.size());
+}
+
+std::string to_string(big_rational const& a) {
+    a.normalize();
+    if (a.den_ == 1) {
+        return to_string(a.num_);
+    }
+    return to_string(a.num_) + "/" + to_string(a.den_);
+}
+
+std::ostream& operator<<(std::ostream& s, big_rational const& a) {
+    return s << to_string(a);
+}
@@ -0,0 +1,70 @@
+#ifndef BIG_RATIONAL_H
+#define BIG_RATIONAL_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <big_integer.h>
+
+// Exact fraction num / den with den > 0. Sums are not reduced right away: the gcd is taken
+// when the operands have grown well past their size at the last reduction, or when the
+// reduced form is asked for (numerator(), denominator(), to_string). Comparisons cross-multiply
+// and never need it.
+struct big_rational {
+    big_rational();
+    big_rational(int a);
+    big_rational(big_integer const& a);
+    big_rational(big_integer const& num, big_integer const& den); // throws on den == 0
+    explicit big_rational(std::string const& str);                  // "a" or "a/b"
+
+    big_rational& operator+=(big_rational const& rhs);
+    big_rational& operator-=(big_rational const& rhs);
+    big_rational& operator*=(big_rational const& rhs);
+    big_rational& operator/=(big_rational const& rhs);
+
+    big_rational operator+() const;
+    big_rational operator-() const;
+
+    big_integer const& numerator() const;                           // of the reduced fraction
+    big_integer const& denominator() const;
+    void normalize() const;
+
+    friend bool operator==(big_rational const& a, big_rational const& b);
+    friend bool operator<(big_rational const& a, big_rational const& b);
+
+    friend std::string to_string(big_rational const& a);
+    friend big_rational sum(big_rational const* terms, size_t count);
+
+ private:
+    void maybe_normalize();
+    size_t limbs() const;
+
+    // lazily reduced, so mutable: the value never changes, only its representation
+    mutable big_integer num_;
+    mutable big_integer den_;
+    mutable bool normalized_;
+    mutable size_t normalized_limbs_;                               // num_ and den_ at the last reduction
+};
+
+big_rational operator+(big_rational a, big_rational const& b);
+big_rational operator-(big_rational a, big_rational const& b);
+big_rational operator*(big_rational a, big_rational const& b);
+big_rational operator/(big_rational a, big_rational const& b);
+
+bool operator==(big_rational const& a, big_rational const& b);
+bool operator!=(big_rational const& a, big_rational const& b);
+bool operator<(big_rational const& a, big_rational const& b);
+bool operator>(big_rational const& a, big_rational const& b);
+bool operator<=(big_rational const& a, big_rational const& b);
+bool operator>=(big_rational const& a, big_rational const& b);
+
+// sum of many terms over one running common denominator: terms that share it cost a single
+// addition, others extend it by den / gcd; reduced once at the end
+big_rational sum(big_rational const* terms, size_t count);
+big_rational sum(std::vector<big_rational> const& terms);
+
+std::string to_string(big_rational const& a);
+std::ostream& operator<<(std::ostream& s, big_rational const& a);
+
+#endif // BIG_RATIONAL_H
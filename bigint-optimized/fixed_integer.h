@@ -0,0 +1,406 @@
+#ifndef FIXED_INTEGER_H
+#define FIXED_INTEGER_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <big_integer.h>
+
+// Bits-wide integer that lives on the stack, arithmetic wraps modulo 2 ^ Bits
+// (two's complement when Signed). All loops have compile-time bounds, so every operation
+// is constexpr and unrolls completely.
+template<size_t Bits, bool Signed = true>
+struct fixed_integer {
+    static_assert(Bits > 0 && Bits % 32 == 0, "fixed_integer width must be a positive multiple of 32");
+    static constexpr size_t LIMBS = Bits / 32;
+    using limbs_t = std::array<uint32_t, LIMBS>;
+
+    constexpr fixed_integer() : limbs_() {}
+
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    constexpr fixed_integer(T a) : limbs_() {
+        uint64_t value = static_cast<uint64_t>(a);                  // sign extends negative values
+        uint32_t fill = (std::is_signed<T>::value && a < T(0)) ? UINT32_MAX : 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] = i < 2 ? static_cast<uint32_t>(value >> (32u * i)) : fill;
+        }
+    }
+
+    template<size_t OtherBits, bool OtherSigned>
+    explicit constexpr fixed_integer(fixed_integer<OtherBits, OtherSigned> const& other) : limbs_() {
+        uint32_t fill = other.is_negative() ? UINT32_MAX : 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] = i < other.LIMBS ? other.limb(i) : fill;
+        }
+    }
+
+    explicit fixed_integer(big_integer const& a) : limbs_() {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] = a.limb(i);
+        }
+    }
+
+    explicit fixed_integer(std::string const& str, int base = 10) : fixed_integer(big_integer(str, base)) {}
+
+    operator big_integer() const {                                  // lossless, so implicit like big_integer(int)
+        return big_integer::from_limbs(limbs_.data(), LIMBS, is_negative());
+    }
+
+    static constexpr fixed_integer from_limbs(limbs_t const& limbs) {
+        fixed_integer result;
+        result.limbs_ = limbs;
+        return result;
+    }
+
+    constexpr limbs_t const& limbs() const {
+        return limbs_;
+    }
+
+    constexpr uint32_t limb(size_t idx) const {
+        return limbs_[idx];
+    }
+
+    constexpr bool is_negative() const {
+        return Signed && (limbs_[LIMBS - 1] >> 31u) != 0;
+    }
+
+    constexpr fixed_integer& operator+=(fixed_integer const& rhs) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t cur = carry + limbs_[i] + rhs.limbs_[i];
+            limbs_[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator-=(fixed_integer const& rhs) {
+        uint64_t carry = 1;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t cur = carry + limbs_[i] + static_cast<uint32_t>(~rhs.limbs_[i]);
+            limbs_[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32u;
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator*=(fixed_integer const& rhs) {
+        limbs_t result{};
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < LIMBS; j++) {
+                uint64_t cur = result[i + j] + static_cast<uint64_t>(limbs_[i]) * rhs.limbs_[j] + carry;
+                result[i + j] = static_cast<uint32_t>(cur);
+                carry = cur >> 32u;
+            }
+        }
+        limbs_ = result;
+        return *this;
+    }
+
+    constexpr fixed_integer& operator/=(fixed_integer const& rhs) {
+        fixed_integer remainder;
+        divide(rhs, remainder);
+        return *this;
+    }
+
+    constexpr fixed_integer& operator%=(fixed_integer const& rhs) {
+        fixed_integer remainder;
+        divide(rhs, remainder);
+        return *this = remainder;
+    }
+
+    constexpr fixed_integer& operator&=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] &= rhs.limbs_[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator|=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] |= rhs.limbs_[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator^=(fixed_integer const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limbs_[i] ^= rhs.limbs_[i];
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator<<=(int rhs) {
+        assert(rhs >= 0);
+        size_t words = static_cast<size_t>(rhs) / 32, bits = static_cast<size_t>(rhs) % 32;
+        for (size_t i = LIMBS; i > 0; --i) {
+            size_t pos = i - 1;
+            uint32_t cur = 0;
+            if (pos >= words) {
+                cur = limbs_[pos - words] << bits;
+                if (bits != 0 && pos > words) {
+                    cur |= limbs_[pos - words - 1] >> (32 - bits);
+                }
+            }
+            limbs_[pos] = cur;
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer& operator>>=(int rhs) {                 // arithmetic for signed, logical for unsigned
+        assert(rhs >= 0);
+        uint32_t fill = is_negative() ? UINT32_MAX : 0;
+        size_t words = static_cast<size_t>(rhs) / 32, bits = static_cast<size_t>(rhs) % 32;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint32_t lo = i + words < LIMBS ? limbs_[i + words] : fill;
+            uint32_t hi = i + words + 1 < LIMBS ? limbs_[i + words + 1] : fill;
+            limbs_[i] = bits == 0 ? lo : ((lo >> bits) | (hi << (32 - bits)));
+        }
+        return *this;
+    }
+
+    constexpr fixed_integer operator+() const {
+        return *this;
+    }
+
+    constexpr fixed_integer operator-() const {
+        return ++(~*this);
+    }
+
+    constexpr fixed_integer operator~() const {
+        fixed_integer result;
+        for (size_t i = 0; i < LIMBS; i++) {
+            result.limbs_[i] = ~limbs_[i];
+        }
+        return result;
+    }
+
+    constexpr fixed_integer& operator++() {
+        for (size_t i = 0; i < LIMBS && ++limbs_[i] == 0; i++) {}
+        return *this;
+    }
+
+    constexpr fixed_integer operator++(int) {
+        fixed_integer r = *this;
+        ++*this;
+        return r;
+    }
+
+    constexpr fixed_integer& operator--() {
+        for (size_t i = 0; i < LIMBS && limbs_[i]-- == 0; i++) {}
+        return *this;
+    }
+
+    constexpr fixed_integer operator--(int) {
+        fixed_integer r = *this;
+        --*this;
+        return r;
+    }
+
+    friend constexpr fixed_integer operator+(fixed_integer a, fixed_integer const& b) { return a += b; }
+    friend constexpr fixed_integer operator-(fixed_integer a, fixed_integer const& b) { return a -= b; }
+    friend constexpr fixed_integer operator*(fixed_integer a, fixed_integer const& b) { return a *= b; }
+    friend constexpr fixed_integer operator/(fixed_integer a, fixed_integer const& b) { return a /= b; }
+    friend constexpr fixed_integer operator%(fixed_integer a, fixed_integer const& b) { return a %= b; }
+
+    friend constexpr fixed_integer operator&(fixed_integer a, fixed_integer const& b) { return a &= b; }
+    friend constexpr fixed_integer operator|(fixed_integer a, fixed_integer const& b) { return a |= b; }
+    friend constexpr fixed_integer operator^(fixed_integer a, fixed_integer const& b) { return a ^= b; }
+
+    friend constexpr fixed_integer operator<<(fixed_integer a, int b) { return a <<= b; }
+    friend constexpr fixed_integer operator>>(fixed_integer a, int b) { return a >>= b; }
+
+    friend constexpr bool operator==(fixed_integer const& a, fixed_integer const& b) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            if (a.limbs_[i] != b.limbs_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator<(fixed_integer const& a, fixed_integer const& b) {
+        if (a.is_negative() != b.is_negative()) {
+            return a.is_negative();
+        }
+        for (size_t i = LIMBS; i > 0; --i) {
+            if (a.limbs_[i - 1] != b.limbs_[i - 1]) {
+                return a.limbs_[i - 1] < b.limbs_[i - 1];
+            }
+        }
+        return false;
+    }
+
+    friend constexpr bool operator!=(fixed_integer const& a, fixed_integer const& b) { return !(a == b); }
+    friend constexpr bool operator>(fixed_integer const& a, fixed_integer const& b) { return b < a; }
+    friend constexpr bool operator<=(fixed_integer const& a, fixed_integer const& b) { return !(b < a); }
+    friend constexpr bool operator>=(fixed_integer const& a, fixed_integer const& b) { return !(a < b); }
+
+    friend std::string to_string(fixed_integer const& a, int base = 10) {
+        return to_string(big_integer(a), base);
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, fixed_integer const& a) {
+        return s << big_integer(a);
+    }
+
+ private:
+    // truncating division, *this becomes the quotient
+    constexpr void divide(fixed_integer const& rhs, fixed_integer& remainder) {
+        bool negative_quotient = is_negative() != rhs.is_negative();
+        bool negative_remainder = is_negative();
+        limbs_t u = is_negative() ? (-*this).limbs_ : limbs_;
+        limbs_t v = rhs.is_negative() ? (-rhs).limbs_ : rhs.limbs_;
+        divide_unsigned(u, v, limbs_, remainder.limbs_);
+        if (negative_quotient) {
+            *this = -*this;
+        }
+        if (negative_remainder) {
+            remainder = -remainder;
+        }
+    }
+
+    // Knuth's algorithm D over 32-bit limbs
+    static constexpr void divide_unsigned(limbs_t const& u, limbs_t const& v, limbs_t& q, limbs_t& r) {
+        size_t n = LIMBS, m = LIMBS;
+        while (n > 0 && v[n - 1] == 0) {
+            n--;
+        }
+        while (m > 0 && u[m - 1] == 0) {
+            m--;
+        }
+        if (n == 0) {
+            throw std::overflow_error("Divide by zero exception");
+        }
+        q = limbs_t{};
+        r = limbs_t{};
+        if (m < n) {
+            r = u;
+            return;
+        }
+        if (n == 1) {
+            uint64_t carry = 0;
+            for (size_t i = m; i > 0; --i) {
+                uint64_t cur = (carry << 32u) | u[i - 1];
+                q[i - 1] = static_cast<uint32_t>(cur / v[0]);
+                carry = cur % v[0];
+            }
+            r[0] = static_cast<uint32_t>(carry);
+            return;
+        }
+        unsigned shift = __builtin_clz(v[n - 1]);
+        uint32_t vn[LIMBS] = {}, un[LIMBS + 1] = {};
+        for (size_t i = n - 1; i > 0; --i) {
+            vn[i] = (v[i] << shift) | (shift ? v[i - 1] >> (32 - shift) : 0);
+        }
+        vn[0] = v[0] << shift;
+        un[m] = shift ? u[m - 1] >> (32 - shift) : 0;
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = (u[i] << shift) | (shift ? u[i - 1] >> (32 - shift) : 0);
+        }
+        un[0] = u[0] << shift;
+        for (size_t j = m - n + 1; j > 0; --j) {
+            size_t k = j - 1;
+            uint64_t top = (static_cast<uint64_t>(un[k + n]) << 32u) | un[k + n - 1];
+            uint64_t q_hat = top / vn[n - 1], r_hat = top % vn[n - 1];
+            while (q_hat > UINT32_MAX || q_hat * vn[n - 2] > ((r_hat << 32u) | un[k + n - 2])) {
+                q_hat--;
+                r_hat += vn[n - 1];
+                if (r_hat > UINT32_MAX) {
+                    break;
+                }
+            }
+            int64_t borrow = 0, t = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t p = q_hat * vn[i];
+                t = static_cast<int64_t>(un[i + k]) - borrow - static_cast<int64_t>(p & UINT32_MAX);
+                un[i + k] = static_cast<uint32_t>(t);
+                borrow = static_cast<int64_t>(p >> 32u) - (t >> 32);
+            }
+            t = static_cast<int64_t>(un[k + n]) - borrow;
+            un[k + n] = static_cast<uint32_t>(t);
+            q[k] = static_cast<uint32_t>(q_hat);
+            if (t < 0) {
+                q[k]--;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; i++) {
+                    uint64_t cur = static_cast<uint64_t>(un[i + k]) + vn[i] + carry;
+                    un[i + k] = static_cast<uint32_t>(cur);
+                    carry = cur >> 32u;
+                }
+                un[k + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            r[i] = (un[i] >> shift) | (shift ? un[i + 1] << (32 - shift) : 0);
+        }
+    }
+
+ private:
+    limbs_t limbs_;
+};
+
+using fixed_int128 = fixed_integer<128, true>;
+using fixed_uint128 = fixed_integer<128, false>;
+using fixed_int256 = fixed_integer<256, true>;
+using fixed_uint256 = fixed_integer<256, false>;
+using fixed_int512 = fixed_integer<512, true>;
+using fixed_uint512 = fixed_integer<512, false>;
+
+namespace big_integer_literals {
+namespace detail {
+    template<char... Chars>
+    struct literal {
+        static constexpr char chars[] = {Chars...};
+        static constexpr size_t size = sizeof...(Chars);
+        static constexpr bool prefixed = size > 2 && chars[0] == '0' && chars[1] != '\'';
+        static constexpr uint32_t base = !prefixed && !(size > 1 && chars[0] == '0') ? 10
+                                         : !prefixed ? 8
+                                         : (chars[1] == 'x' || chars[1] == 'X') ? 16
+                                         : (chars[1] == 'b' || chars[1] == 'B') ? 2 : 8;
+        static constexpr size_t first = (base == 16 || base == 2) ? 2 : 0;
+
+        static constexpr size_t digit_count() {
+            size_t count = 0;
+            for (size_t i = first; i < size; i++) {
+                count += (chars[i] != '\'');
+            }
+            return count;
+        }
+
+        // enough bits for the magnitude plus a sign bit, so the literal can be negated
+        static constexpr size_t bits_needed = base == 10 ? digit_count() * 3322 / 1000 + 1
+                                                         : digit_count() * (base == 16 ? 4 : base == 8 ? 3 : 1);
+        static constexpr size_t bits = (bits_needed + 1 + 31) / 32 * 32;
+
+        static constexpr uint32_t digit(char c) {
+            return c <= '9' ? c - '0' : c <= 'F' ? c - 'A' + 10 : c - 'a' + 10;
+        }
+
+        static constexpr fixed_integer<bits, true> parse() {
+            fixed_integer<bits, true> result;
+            for (size_t i = first; i < size; i++) {
+                if (chars[i] != '\'') {
+                    result = result * base + digit(chars[i]);
+                }
+            }
+            return result;
+        }
+    };
+}
+
+// 1234567890123456789012345678901234567890_bi, 0xffff'ffff'0000'0001_bi: parsed by the compiler into
+// a constexpr fixed_integer just wide enough for the value, which converts to big_integer without a parse
+template<char... Chars>
+constexpr fixed_integer<detail::literal<Chars...>::bits, true> operator""_bi() {
+    return detail::literal<Chars...>::parse();
+}
+}
+
+#endif // FIXED_INTEGER_H
@@ -0,0 +1,67 @@
+#include "product_tree.h"
+
+#include <stdexcept>
+#include <utility>
+
+product_tree::product_tree(std::vector<big_integer> const& moduli) : levels_(1, moduli) {
+    if (moduli.empty()) {
+        throw std::invalid_argument("Product tree needs at least one modulus");
+    }
+    for (big_integer const& m : moduli) {
+        if (m == 0) {
+            throw std::overflow_error("Divide by zero exception");
+        }
+        if (m < 0) {
+            throw std::invalid_argument("Product tree moduli must be positive");
+        }
+        divisors_.emplace_back(m.limb_count() == 1 ? m.limb(0) : 1);
+    }
+    while (levels_.back().size() > 1) {
+        std::vector<big_integer> const& level = levels_.back();
+        std::vector<big_integer> parent;
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+            parent.push_back(level[i] * level[i + 1]);
+        }
+        if (level.size() % 2 != 0) {
+            parent.push_back(level.back());
+        }
+        levels_.push_back(std::move(parent));
+    }
+}
+
+size_t product_tree::size() const {
+    return levels_[0].size();
+}
+
+big_integer const& product_tree::modulus(size_t idx) const {
+    return levels_[0][idx];
+}
+
+big_integer const& product_tree::product() const {
+    return levels_.back()[0];
+}
+
+// node j of a level has parent j / 2, also for the odd node carried up unchanged
+std::vector<big_integer> remainders(big_integer const& x, product_tree const& tree) {
+    std::vector<big_integer> level{remainder(x, tree.product(), division_rounding::floor)};
+    for (size_t k = tree.levels_.size() - 1; k-- > 0;) {
+        std::vector<big_integer> const& nodes = tree.levels_[k];
+        std::vector<big_integer> next(nodes.size());
+        for (size_t j = 0; j < nodes.size(); j++) {
+            big_integer const& parent = level[j / 2];
+            if (parent < nodes[j]) {
+                next[j] = parent;                                   // shares the limbs
+            } else if (k == 0 && nodes[j].limb_count() == 1) {
+                next[j] = parent % tree.divisors_[j];
+            } else {
+                next[j] = parent % nodes[j];
+            }
+        }
+        level = std::move(next);
+    }
+    return level;
+}
+
+std::vector<big_integer> remainders(big_integer const& x, std::vector<big_integer> const& moduli) {
+    return remainders(x, product_tree(moduli));
+}
@@ -0,0 +1,32 @@
+#ifndef PRODUCT_TREE_H
+#define PRODUCT_TREE_H
+
+#include <cstddef>
+#include <vector>
+#include <big_integer.h>
+
+// Binary tree of products over a fixed list of positive moduli: leaves are the moduli, each
+// node the product of its children, the root the product of all. Built once, it reduces any
+// number of values modulo every leaf with about two full-size divisions' worth of work per
+// value instead of one division per modulus.
+struct product_tree {
+    explicit product_tree(std::vector<big_integer> const& moduli); // throws unless every modulus is positive
+
+    size_t size() const;
+    big_integer const& modulus(size_t idx) const;
+    big_integer const& product() const;
+
+    friend std::vector<big_integer> remainders(big_integer const& x, product_tree const& tree);
+
+ private:
+    std::vector<std::vector<big_integer>> levels_;                  // levels_[0] are the moduli, levels_.back() is {product}
+    std::vector<divisor> divisors_;                                 // of the single-limb moduli, 1 for the others
+};
+
+// x mod m_i in [0, m_i) for every modulus, top down: the root reduces x, then each node takes its
+// parent's remainder modulo its own product, so divisions shrink with the nodes. Single-limb
+// leaves finish on the precomputed divisor, without a hardware divide.
+std::vector<big_integer> remainders(big_integer const& x, product_tree const& tree);
+std::vector<big_integer> remainders(big_integer const& x, std::vector<big_integer> const& moduli);
+
+#endif // PRODUCT_TREE_H
@@ -0,0 +1,232 @@
+#include "rns_integer.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    __extension__ typedef unsigned __int128 uint128_t;             // a GCC extension, named once for -pedantic
+
+    const uint32_t LARGEST_PRIME = 2147483647;                      // 2^31 - 1: a + b of two residues fits a limb
+
+    uint32_t pow_mod(uint64_t base, uint32_t exp, uint32_t mod) {
+        uint64_t result = 1;
+        for (base %= mod; exp != 0; exp >>= 1) {
+            if (exp & 1) {
+                result = result * base % mod;
+            }
+            base = base * base % mod;
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    // Miller-Rabin with bases 2, 3, 5 and 7 is exact below 3215031751
+    bool is_prime(uint32_t n) {
+        if (n < 2) {
+            return false;
+        }
+        for (uint32_t p : {2u, 3u, 5u, 7u}) {
+            if (n % p == 0) {
+                return n == p;
+            }
+        }
+        uint32_t d = n - 1;
+        unsigned s = 0;
+        for (; d % 2 == 0; d /= 2) {
+            s++;
+        }
+        for (uint32_t a : {2u, 3u, 5u, 7u}) {
+            uint64_t x = pow_mod(a, d, n);
+            if (x == 1 || x == n - 1) {
+                continue;
+            }
+            bool composite = true;
+            for (unsigned r = 1; r < s && composite; r++) {
+                x = x * x % n;
+                composite = x != n - 1;
+            }
+            if (composite) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t inverse_mod(uint32_t a, uint32_t mod) {
+        int64_t t = 0, new_t = 1, r = mod, new_r = a;
+        while (new_r != 0) {
+            int64_t q = r / new_r;
+            t = std::exchange(new_t, t - q * new_t);
+            r = std::exchange(new_r, r - q * new_r);
+        }
+        return static_cast<uint32_t>(t < 0 ? t + mod : t);
+    }
+
+    // x < 2^62: the estimated quotient is at most one short, so a single correction is enough
+    uint32_t reduce(uint64_t x, uint32_t p, uint64_t reciprocal) {
+        uint128_t wide = x;
+        uint64_t q = static_cast<uint64_t>(wide * reciprocal >> 64);
+        uint64_t r = x - q * p;
+        return static_cast<uint32_t>(r >= p ? r - p : r);
+    }
+
+    std::vector<uint32_t> choose_primes(size_t bits) {
+        std::vector<uint32_t> primes;
+        big_integer product = 1;
+        for (uint32_t candidate = LARGEST_PRIME; product.bit_length() < bits + 2; candidate -= 2) {
+            if (is_prime(candidate)) {
+                primes.push_back(candidate);
+                product *= candidate;
+            }
+        }
+        return primes;
+    }
+
+    void check_basis(rns_integer const& a, rns_integer const& b) {
+        if (&a.basis() != &b.basis()) {
+            throw std::invalid_argument("RNS operands have different bases");
+        }
+    }
+}
+
+rns_basis::rns_basis(size_t bits)
+    : primes_(choose_primes(bits)), tree_(std::vector<big_integer>(primes_.begin(), primes_.end())) {
+    for (uint32_t p : primes_) {
+        divisor d(p);
+        reciprocals_.push_back(UINT64_MAX / p);
+        cofactors_.push_back(modulus() / d);
+        inverses_.push_back(inverse_mod((cofactors_.back() % d).limb(0), p));
+    }
+}
+
+size_t rns_basis::size() const {
+    return primes_.size();
+}
+
+uint32_t rns_basis::prime(size_t idx) const {
+    return primes_[idx];
+}
+
+big_integer const& rns_basis::modulus() const {
+    return tree_.product();
+}
+
+rns_integer::rns_integer(rns_basis const& basis, big_integer const& x)
+    : basis_(&basis), residues_(basis.size()) {
+    std::vector<big_integer> r = remainders(x, basis.tree_);
+    for (size_t j = 0; j < residues_.size(); j++) {
+        residues_[j] = r[j].limb(0);
+    }
+}
+
+rns_basis const& rns_integer::basis() const {
+    return *basis_;
+}
+
+uint32_t rns_integer::residue(size_t idx) const {
+    return residues_[idx];
+}
+
+// x = sum(((r_i * (M / p_i)^-1) mod p_i) * M / p_i) mod M
+big_integer rns_integer::to_big_integer() const {
+    rns_basis const& basis = *basis_;
+    big_integer result, term;
+    for (size_t i = 0; i < residues_.size(); i++) {
+        uint64_t scaled = static_cast<uint64_t>(residues_[i]) * basis.inverses_[i];
+        mul(term, basis.cofactors_[i], big_integer(reduce(scaled, basis.primes_[i], basis.reciprocals_[i])));
+        result += term;
+    }
+    result %= basis.modulus();
+    if ((result << 1) > basis.modulus()) {
+        result -= basis.modulus();
+    }
+    return result;
+}
+
+rns_integer& rns_integer::operator+=(rns_integer const& rhs) {
+    add(*this, *this, rhs);
+    return *this;
+}
+
+rns_integer& rns_integer::operator-=(rns_integer const& rhs) {
+    sub(*this, *this, rhs);
+    return *this;
+}
+
+rns_integer& rns_integer::operator*=(rns_integer const& rhs) {
+    mul(*this, *this, rhs);
+    return *this;
+}
+
+rns_integer rns_integer::operator-() const {
+    rns_integer result(*this);
+    std::vector<uint32_t> const& primes = basis_->primes_;
+    for (size_t i = 0; i < residues_.size(); i++) {
+        result.residues_[i] = residues_[i] == 0 ? 0 : primes[i] - residues_[i];
+    }
+    return result;
+}
+
+rns_integer operator+(rns_integer a, rns_integer const& b) {
+    return a += b;
+}
+
+rns_integer operator-(rns_integer a, rns_integer const& b) {
+    return a -= b;
+}
+
+rns_integer operator*(rns_integer a, rns_integer const& b) {
+    return a *= b;
+}
+
+// the loops below are independent per residue and branch-free, so the compiler vectorizes add and sub
+void add(rns_integer& dst, rns_integer const& a, rns_integer const& b) {
+    check_basis(a, b);
+    size_t n = a.residues_.size();
+    uint32_t const* p = a.basis_->primes_.data();
+    dst.basis_ = a.basis_;
+    dst.residues_.resize(n);
+    uint32_t* d = dst.residues_.data();
+    uint32_t const* x = a.residues_.data();
+    uint32_t const* y = b.residues_.data();
+    for (size_t i = 0; i < n; i++) {
+        uint32_t s = x[i] + y[i];                                   // < 2^32, primes are below 2^31
+        d[i] = s >= p[i] ? s - p[i] : s;
+    }
+}
+
+void sub(rns_integer& dst, rns_integer const& a, rns_integer const& b) {
+    check_basis(a, b);
+    size_t n = a.residues_.size();
+    uint32_t const* p = a.basis_->primes_.data();
+    dst.basis_ = a.basis_;
+    dst.residues_.resize(n);
+    uint32_t* d = dst.residues_.data();
+    uint32_t const* x = a.residues_.data();
+    uint32_t const* y = b.residues_.data();
+    for (size_t i = 0; i < n; i++) {
+        uint32_t s = x[i] - y[i];
+        d[i] = x[i] < y[i] ? s + p[i] : s;
+    }
+}
+
+void mul(rns_integer& dst, rns_integer const& a, rns_integer const& b) {
+    check_basis(a, b);
+    rns_basis const& basis = *a.basis_;
+    size_t n = a.residues_.size();
+    dst.basis_ = a.basis_;
+    dst.residues_.resize(n);
+    uint32_t* d = dst.residues_.data();
+    uint32_t const* x = a.residues_.data();
+    uint32_t const* y = b.residues_.data();
+    for (size_t i = 0; i < n; i++) {
+        d[i] = reduce(static_cast<uint64_t>(x[i]) * y[i], basis.primes_[i], basis.reciprocals_[i]);
+    }
+}
+
+bool operator==(rns_integer const& a, rns_integer const& b) {
+    return a.basis_ == b.basis_ && a.residues_ == b.residues_;
+}
+
+bool operator!=(rns_integer const& a, rns_integer const& b) {
+    return !(a == b);
+}
@@ -0,0 +1,74 @@
+#ifndef RNS_INTEGER_H
+#define RNS_INTEGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <big_integer.h>
+#include <product_tree.h>
+
+struct rns_integer;
+
+// Primes p_i < 2^31 whose product M exceeds 2^(bits + 1), with everything conversions need:
+// the product tree of the p_i for reducing into residues, and M / p_i with its inverse
+// modulo p_i for the Chinese remainder theorem on the way back.
+struct rns_basis {
+    explicit rns_basis(size_t bits);                                // every |x| < 2^bits round-trips
+
+    size_t size() const;
+    uint32_t prime(size_t idx) const;
+    big_integer const& modulus() const;
+
+ private:
+    friend struct rns_integer;
+    friend void add(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+    friend void sub(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+    friend void mul(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+
+    std::vector<uint32_t> primes_;
+    std::vector<uint64_t> reciprocals_;                             // floor((2^64 - 1) / p_i), for Barrett reduction
+    product_tree tree_;
+    std::vector<big_integer> cofactors_;                            // M / p_i
+    std::vector<uint32_t> inverses_;                                // (M / p_i)^-1 mod p_i
+};
+
+// x modulo every prime of a basis. Additions, subtractions and multiplications are residue by
+// residue, with no carries between them, so long chains cost O(size()) each and reduce once, in
+// to_big_integer(), which returns the representative in (-M / 2, M / 2). The basis must outlive
+// the value, and both operands of an operation must share it.
+struct rns_integer {
+    rns_integer(rns_basis const& basis, big_integer const& x);
+
+    rns_basis const& basis() const;
+    uint32_t residue(size_t idx) const;
+    big_integer to_big_integer() const;
+
+    rns_integer& operator+=(rns_integer const& rhs);
+    rns_integer& operator-=(rns_integer const& rhs);
+    rns_integer& operator*=(rns_integer const& rhs);
+
+    rns_integer operator-() const;
+
+    friend void add(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+    friend void sub(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+    friend void mul(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+    friend bool operator==(rns_integer const& a, rns_integer const& b);
+
+ private:
+    rns_basis const* basis_;
+    std::vector<uint32_t> residues_;
+};
+
+rns_integer operator+(rns_integer a, rns_integer const& b);
+rns_integer operator-(rns_integer a, rns_integer const& b);
+rns_integer operator*(rns_integer a, rns_integer const& b);
+
+// dst may alias a or b; throw std::invalid_argument if the bases differ
+void add(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+void sub(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+void mul(rns_integer& dst, rns_integer const& a, rns_integer const& b);
+
+bool operator==(rns_integer const& a, rns_integer const& b);        // equal modulo M
+bool operator!=(rns_integer const& a, rns_integer const& b);
+
+#endif // RNS_INTEGER_H
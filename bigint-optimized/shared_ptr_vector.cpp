@@ -3,17 +3,28 @@
 //
 
 #include "shared_ptr_vector.h"
+#include "big_integer_stats.h"
 
 #include <utility>
 
 shared_ptr_vector::shared_ptr_vector(std::vector<uint32_t> rhs)
-: ref_counter(1), data(std::move(rhs)) {}
+: ref_counter(1), hash(0), data(std::move(rhs)) {
+    BIGINT_STATS_ALLOCATION();
+}
 
 shared_ptr_vector *shared_ptr_vector::get_unique() {
     if (ref_counter == 1) {
+        hash = 0;
         return this;
     }
+    BIGINT_STATS_UNSHARE();
     auto *new_p = new shared_ptr_vector(data);
-    ref_counter--;
+    release();
     return new_p;
 }
+
+void shared_ptr_vector::release() {
+    if (ref_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
@@ -5,6 +5,7 @@
 #ifndef BIGINT__SHARED_PTR_VECTOR_H_
 #define BIGINT__SHARED_PTR_VECTOR_H_
 
+#include <atomic>
 #include <vector>
 #include <cstdint>
 #include <cstddef>
@@ -12,7 +13,9 @@
 struct shared_ptr_vector {
     explicit shared_ptr_vector(std::vector<uint32_t> rhs);
     shared_ptr_vector *get_unique();
-    size_t ref_counter;
+    void release();                                                 // drops one reference, deletes on the last
+    std::atomic<size_t> ref_counter;                                // atomic, so copies may be shared across threads
+    std::atomic<size_t> hash;                                       // 0 -- not computed, reset by get_unique
     std::vector<uint32_t> data;
 };
 
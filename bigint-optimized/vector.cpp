@@ -3,15 +3,24 @@
 //
 
 #include <vector.h>
+#include "big_integer_stats.h"
 #include <cstring>
 #include <cassert>
 
+namespace {
+    void count_regrowth(std::vector<uint32_t> const& data, size_t old_capacity) { // the limbs moved to a new buffer
+        if (data.capacity() != old_capacity) {
+            BIGINT_STATS_ALLOCATION();
+        }
+    }
+}
+
 vector::vector() : size_(1u) {}
 
-vector::vector(size_t n) { set_size(n); }
+vector::vector(size_t n) : vector(n, 0) {}
 
 vector::vector(size_t n,
-               uint32_t assign) {
+               uint32_t assign) : size_(0) {
     set_size(n);
     if (n <= MAX_SMALL) {
         set_small();
@@ -56,10 +65,7 @@ vector::vector(const vector &rhs) : size_(rhs.size_) {
 
 vector::~vector() {
     if (!is_small()) {
-        ptr->ref_counter--;
-        if (ptr->ref_counter == 0) {
-            delete ptr;
-        }
+        ptr->release();
     }
 }
 
@@ -94,6 +100,18 @@ uint32_t &vector::operator[](size_t idx) {
     }
 }
 
+uint32_t const *vector::data() const {
+    return is_small() ? small_data : ptr->data.data();
+}
+
+uint32_t *vector::data() {
+    if (is_small()) {
+        return small_data;
+    }
+    ptr = ptr->get_unique();
+    return ptr->data.data();
+}
+
 size_t vector::size() const {
     return get_size();
 }
@@ -118,7 +136,9 @@ void vector::push_back(uint32_t const &val) {
     } else {
         ptr = ptr->get_unique();
     }
+    size_t capacity = ptr->data.capacity();
     ptr->data.push_back(val);
+    count_regrowth(ptr->data, capacity);
 }
 
 void vector::pop_back() {
@@ -130,6 +150,16 @@ void vector::pop_back() {
     }
 }
 
+void vector::truncate(size_t new_size) {
+    assert(new_size <= get_size());
+    if (is_small()) {
+        set_size(new_size);
+    } else {
+        ptr = ptr->get_unique();
+        ptr->data.resize(new_size);
+    }
+}
+
 void vector::resize(size_t new_size, uint32_t assign) {
     assert(new_size >= get_size());
     if (is_small() && new_size <= MAX_SMALL) {
@@ -141,7 +171,41 @@ void vector::resize(size_t new_size, uint32_t assign) {
         } else {
             ptr = ptr->get_unique();
         }
+        size_t capacity = ptr->data.capacity();
         ptr->data.resize(new_size, assign);
+        count_regrowth(ptr->data, capacity);
+    }
+}
+
+void vector::assign(size_t new_size, uint32_t value) {
+    if (is_small() && new_size <= MAX_SMALL) {
+        std::fill(small_data, small_data + new_size, value);
+        set_size(new_size);
+    } else if (is_small()) {
+        ptr = new shared_ptr_vector(std::vector<uint32_t>(new_size, value));
+        set_big();
+    } else if (ptr->ref_counter == 1) {
+        ptr->hash = 0;
+        size_t capacity = ptr->data.capacity();
+        ptr->data.assign(new_size, value);
+        count_regrowth(ptr->data, capacity);
+    } else {
+        ptr->release();
+        ptr = new shared_ptr_vector(std::vector<uint32_t>(new_size, value));
+    }
+}
+
+bool vector::get_cached_hash(size_t &hash) const {
+    if (is_small() || ptr->hash == 0) {
+        return false;
+    }
+    hash = ptr->hash;
+    return true;
+}
+
+void vector::set_cached_hash(size_t hash) const {
+    if (!is_small()) {
+        ptr->hash = hash;
     }
 }
 
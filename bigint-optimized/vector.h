@@ -17,12 +17,18 @@ struct vector {
 
     uint32_t const &operator[](size_t idx) const;
     uint32_t &operator[](size_t idx);
+    uint32_t const *data() const;
+    uint32_t *data();
     size_t size() const;
     uint32_t back() const;
     void push_back(uint32_t const &);
     void pop_back();
+    void truncate(size_t new_size);                                 // new_size <= size(), unshares once
     void resize(size_t new_size, uint32_t assign);
+    void assign(size_t new_size, uint32_t value);                  // reuses the heap block when not shared
     void swap(vector &rhs);
+    bool get_cached_hash(size_t &hash) const;
+    void set_cached_hash(size_t hash) const;
     friend bool operator==(vector const &, vector const &);
 
  private: